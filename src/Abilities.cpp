@@ -520,14 +520,12 @@ bool doDamageNDebuff(Mob *mob, sSkillResult_Damage_N_Debuff *respdata, int i, in
         }
 
         respdata[i].bProtected = 0;
-        std::pair<CNSocket*, int32_t> key = std::make_pair(sock, bitFlag);
-        time_t until = getTime() + (time_t)duration * 100;
-        Eggs::EggBuffs[key] = until;
+        Eggs::addEggBuff(sock, bitFlag, getTime() + (time_t)duration * 100);
     }
     respdata[i].iConditionBitFlag = plr->iConditionBitFlag;
 
     if (plr->HP <= 0) {
-        mob->target = nullptr;
+        mob->target = {};
         mob->state = MobState::RETREAT;
         if (!MobAI::aggroCheck(mob, getTime())) {
             MobAI::clearDebuff(mob);
@@ -590,7 +588,7 @@ bool doDamage(Mob *mob, sSkillResult_Damage *respdata, int i, int32_t targetID,
         return false;
     }
 
-    int damage = amount * PC_MAXHEALTH((int)mob->data["m_iNpcLevel"]) / 1500;
+    int damage = amount * PC_MAXHEALTH(mob->data->level) / 1500;
 
     if (plr->iSpecialState & CN_SPECIAL_STATE_FLAG__INVULNERABLE)
         damage = 0;
@@ -601,7 +599,7 @@ bool doDamage(Mob *mob, sSkillResult_Damage *respdata, int i, int32_t targetID,
     respdata[i].iHP = plr->HP -= damage;
 
     if (plr->HP <= 0) {
-        mob->target = nullptr;
+        mob->target = {};
         mob->state = MobState::RETREAT;
         if (!MobAI::aggroCheck(mob, getTime())) {
             MobAI::clearDebuff(mob);
@@ -659,7 +657,7 @@ bool doLeech(Mob *mob, sSkillResult_Heal_HP *healdata, int i, int32_t targetID,
     damagedata->iHP = plr->HP -= damage;
 
     if (plr->HP <= 0) {
-        mob->target = nullptr;
+        mob->target = {};
         mob->state = MobState::RETREAT;
         if (!MobAI::aggroCheck(mob, getTime())) {
             MobAI::clearDebuff(mob);
@@ -696,8 +694,8 @@ bool doBatteryDrain(Mob *mob, sSkillResult_BatteryDrain *respdata, int i, int32_
         respdata[i].iDrainN = 0;
     } else {
         respdata[i].bProtected = 0;
-        respdata[i].iDrainW = amount * (18 + (int)mob->data["m_iNpcLevel"]) / 36;
-        respdata[i].iDrainN = amount * (18 + (int)mob->data["m_iNpcLevel"]) / 36;
+        respdata[i].iDrainW = amount * (18 + mob->data->level) / 36;
+        respdata[i].iDrainN = amount * (18 + mob->data->level) / 36;
     }
 
     respdata[i].iBatteryW = plr->batteryW -= (respdata[i].iDrainW < plr->batteryW) ? respdata[i].iDrainW : plr->batteryW;
@@ -112,7 +112,7 @@ static void announcementHandler(CNSocket* sock, CNPacketData* data) {
     msg.iAnnounceType = announcement->iAnnounceType;
     msg.iDuringTime = announcement->iDuringTime;
     memcpy(msg.szAnnounceMsg, announcement->szAnnounceMsg, sizeof(msg.szAnnounceMsg));
-    std::map<CNSocket*, Player*>::iterator it;
+    std::unordered_map<CNSocket*, Player*>::iterator it;
 
     switch (announcement->iAreaType) {
     case 0: // area (all players in viewable chunks)
@@ -7,7 +7,125 @@
 
 using namespace Chunking;
 
-std::map<ChunkPos, Chunk*> Chunking::chunks;
+ChunkMap Chunking::chunks;
+ObjectPool<std::set<Chunk*>> Chunking::ViewableSets("viewableChunks");
+
+static SlabPool chunkPool("Chunk", sizeof(Chunk));
+
+void* Chunk::operator new(size_t size) {
+    return chunkPool.alloc(size);
+}
+
+void Chunk::operator delete(void* p, size_t size) {
+    chunkPool.free(p, size);
+}
+
+// every chunk in an instance, so instances can be checked and torn down without scanning the whole world
+struct InstanceChunks {
+    std::vector<Chunk*> chunks;
+    int players = 0;
+};
+
+static std::unordered_map<uint64_t, InstanceChunks> instances;
+
+// ========================================================[[ ChunkMap ]]========================================================
+
+static uint64_t packChunkXY(int x, int y) {
+    return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+}
+
+static size_t hashChunk(uint64_t xy, uint64_t instance) {
+    // splitmix64 finalizer over both words
+    uint64_t h = xy ^ (instance * 0x9E3779B97F4A7C15ULL);
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    return (size_t)(h ^ (h >> 31));
+}
+
+ChunkMap::ChunkMap() {
+    slots.resize(1024, {0, 0, nullptr});
+}
+
+// returns the slot holding the key, or the empty slot it would go in
+size_t ChunkMap::probe(uint64_t xy, uint64_t instance) {
+    size_t mask = slots.size() - 1;
+    size_t i = hashChunk(xy, instance) & mask;
+
+    while (slots[i].chunk != nullptr && (slots[i].xy != xy || slots[i].instance != instance))
+        i = (i + 1) & mask;
+
+    return i;
+}
+
+void ChunkMap::grow() {
+    std::vector<Slot> old(slots.size() * 2, {0, 0, nullptr});
+    old.swap(slots);
+
+    for (Slot& slot : old) {
+        if (slot.chunk != nullptr)
+            slots[probe(slot.xy, slot.instance)] = slot;
+    }
+}
+
+Chunk* ChunkMap::find(ChunkPos pos) {
+    int x, y;
+    uint64_t inst;
+    std::tie(x, y, inst) = pos;
+
+    return slots[probe(packChunkXY(x, y), inst)].chunk;
+}
+
+void ChunkMap::insert(ChunkPos pos, Chunk* chunk) {
+    // keep the load factor under 1/2 so probe sequences stay short
+    if ((count + 1) * 2 > slots.size())
+        grow();
+
+    int x, y;
+    uint64_t inst;
+    std::tie(x, y, inst) = pos;
+    uint64_t xy = packChunkXY(x, y);
+
+    Slot& slot = slots[probe(xy, inst)];
+    if (slot.chunk == nullptr)
+        count++;
+    slot = {xy, inst, chunk};
+}
+
+void ChunkMap::erase(ChunkPos pos) {
+    int x, y;
+    uint64_t inst;
+    std::tie(x, y, inst) = pos;
+
+    size_t mask = slots.size() - 1;
+    size_t i = probe(packChunkXY(x, y), inst);
+    if (slots[i].chunk == nullptr)
+        return; // not in the map
+
+    slots[i].chunk = nullptr;
+    count--;
+
+    /*
+     * Backward-shift deletion: pull later entries of the same probe run into the hole,
+     * so lookups never have to step over tombstones.
+     */
+    size_t j = i;
+    while (true) {
+        j = (j + 1) & mask;
+        if (slots[j].chunk == nullptr)
+            break;
+
+        size_t home = hashChunk(slots[j].xy, slots[j].instance) & mask;
+        // only move the entry if its home slot isn't cyclically within (i, j]
+        bool movable = (i <= j) ? (home <= i || home > j) : (home <= i && home > j);
+        if (movable) {
+            slots[i] = slots[j];
+            slots[j].chunk = nullptr;
+            i = j;
+        }
+    }
+}
+
+// ========================================================[[ Chunking ]]========================================================
 
 static void newChunk(ChunkPos pos) {
     if (chunkExists(pos)) {
@@ -16,14 +134,16 @@ static void newChunk(ChunkPos pos) {
     }
 
     Chunk *chunk = new Chunk();
+    chunk->pos = pos;
 
-    chunk->players = std::set<CNSocket*>();
-    chunk->NPCs = std::set<int32_t>();
+    chunks.insert(pos, chunk);
 
-    chunks[pos] = chunk;
+    InstanceChunks& inst = instances[std::get<2>(pos)];
+    chunk->instanceIndex = inst.chunks.size();
+    inst.chunks.push_back(chunk);
 
     // add the chunk to the cache of all players and NPCs in the surrounding chunks
-    std::set<Chunk*> surroundings = getViewableChunks(pos);
+    NearbyChunks surroundings = getViewableChunks(pos);
     for (Chunk* c : surroundings) {
         for (CNSocket* sock : c->players)
             PlayerManager::getPlayer(sock)->viewableChunks->insert(chunk);
@@ -38,10 +158,10 @@ static void deleteChunk(ChunkPos pos) {
         return;
     }
 
-    Chunk* chunk = chunks[pos];
+    Chunk* chunk = chunks.find(pos);
 
     // remove the chunk from the cache of all players and NPCs in the surrounding chunks
-    std::set<Chunk*> surroundings = getViewableChunks(pos);
+    NearbyChunks surroundings = getViewableChunks(pos);
     for(Chunk* c : surroundings)
     {
         for (CNSocket* sock : c->players)
@@ -51,30 +171,93 @@ static void deleteChunk(ChunkPos pos) {
     }
 
     chunks.erase(pos); // remove from map
+
+    // swap-remove from the instance's chunk list
+    auto it = instances.find(std::get<2>(pos));
+    std::vector<Chunk*>& instChunks = it->second.chunks;
+    instChunks[chunk->instanceIndex] = instChunks.back();
+    instChunks[chunk->instanceIndex]->instanceIndex = chunk->instanceIndex;
+    instChunks.pop_back();
+
+    if (instChunks.empty())
+        instances.erase(it);
     delete chunk; // free from memory
 }
 
+// adds val to vec if it isn't there already; returns whether it was added
+template<class T>
+static bool addMember(std::vector<T>& vec, T val) {
+    if (std::find(vec.begin(), vec.end(), val) != vec.end())
+        return false;
+
+    vec.push_back(val);
+    return true;
+}
+
+// removes val from vec by swapping the last element into its place; returns whether it was there
+template<class T>
+static bool removeMember(std::vector<T>& vec, T val) {
+    auto it = std::find(vec.begin(), vec.end(), val);
+    if (it == vec.end())
+        return false;
+
+    *it = vec.back();
+    vec.pop_back();
+    return true;
+}
+
+/*
+ * Everything needed to stamp out a copy of a map's NPCs, captured from the base
+ * instance the first time it's instantiated and shared by every copy after that.
+ * Only plain spawn values are kept; mobs point at the shared NPC table entry for
+ * everything else, so each copy only owns its own mutable state.
+ */
+struct TemplateSpawn {
+    int32_t type;
+    int x, y, z, angle;
+    bool isMob;
+    int leader; // index of the group leader's spawn, or -1
+    int memberSlot; // slot in the leader's groupMember array (followers only)
+    int offsetX, offsetY;
+};
+
+/*
+ * Spawn lists for instanced maps, by map number; see getInstanceTemplate().
+ * An NPC coming or going in a map's base instance (gruntwork, /summonW, NPC destruction)
+ * drops its entry, so the next copy of it is stamped out from what's there now.
+ */
+static std::unordered_map<uint64_t, std::vector<TemplateSpawn>> instanceTemplates;
+
+static void invalidateInstanceTemplate(uint64_t instanceID) {
+    if (PLAYERID(instanceID) == 0)
+        instanceTemplates.erase(MAPNUM(instanceID));
+}
+
 void Chunking::trackPlayer(ChunkPos chunkPos, CNSocket* sock) {
-    if (!chunkExists(chunkPos))
+    Chunk* chunk = chunks.find(chunkPos);
+    if (chunk == nullptr)
         return; // shouldn't happen
 
-    chunks[chunkPos]->players.insert(sock);
+    if (addMember(chunk->players, sock))
+        instances[std::get<2>(chunkPos)].players++;
 }
 
 void Chunking::trackNPC(ChunkPos chunkPos, int32_t id) {
-    if (!chunkExists(chunkPos))
+    Chunk* chunk = chunks.find(chunkPos);
+    if (chunk == nullptr)
         return; // shouldn't happen
 
-    chunks[chunkPos]->NPCs.insert(id);
+    addMember(chunk->NPCs, id);
+    invalidateInstanceTemplate(std::get<2>(chunkPos));
 }
 
 void Chunking::untrackPlayer(ChunkPos chunkPos, CNSocket* sock) {
-    if (!chunkExists(chunkPos))
+    Chunk* chunk = chunks.find(chunkPos);
+    if (chunk == nullptr)
         return; // do nothing if chunk doesn't even exist
 
-    Chunk* chunk = chunks[chunkPos];
-
-    chunk->players.erase(sock); // gone
+    if (removeMember(chunk->players, sock)) // gone
+        instances[std::get<2>(chunkPos)].players--;
 
     // if chunk is empty, free it
     if (chunk->NPCs.size() == 0 && chunk->players.size() == 0)
@@ -82,19 +265,19 @@ void Chunking::untrackPlayer(ChunkPos chunkPos, CNSocket* sock) {
 }
 
 void Chunking::untrackNPC(ChunkPos chunkPos, int32_t id) {
-    if (!chunkExists(chunkPos))
+    Chunk* chunk = chunks.find(chunkPos);
+    if (chunk == nullptr)
         return; // do nothing if chunk doesn't even exist
 
-    Chunk* chunk = chunks[chunkPos];
-
-    chunk->NPCs.erase(id); // gone
+    if (removeMember(chunk->NPCs, id)) // gone
+        invalidateInstanceTemplate(std::get<2>(chunkPos));
 
     // if chunk is empty, free it
     if (chunk->NPCs.size() == 0 && chunk->players.size() == 0)
         deleteChunk(chunkPos);
 }
 
-void Chunking::addPlayerToChunks(std::set<Chunk*> chnks, CNSocket* sock) {
+void Chunking::addPlayerToChunks(NearbyChunks chnks, CNSocket* sock) {
     INITSTRUCT(sP_FE2CL_PC_NEW, newPlayer);
 
     for (Chunk* chunk : chnks) {
@@ -102,6 +285,7 @@ void Chunking::addPlayerToChunks(std::set<Chunk*> chnks, CNSocket* sock) {
         for (int32_t id : chunk->NPCs) {
             BaseNPC* npc = NPCManager::NPCs[id];
             npc->playersInView++;
+            MobAI::updateActive(npc);
 
             if (npc->appearanceData.iHP <= 0)
                 continue;
@@ -166,51 +350,59 @@ void Chunking::addPlayerToChunks(std::set<Chunk*> chnks, CNSocket* sock) {
     }
 }
 
-void Chunking::addNPCToChunks(std::set<Chunk*> chnks, int32_t id) {
+void Chunking::addNPCToChunks(NearbyChunks chnks, int32_t id) {
     BaseNPC* npc = NPCManager::NPCs[id];
 
     switch (npc->npcClass) {
-    case NPC_BUS:
+    case NPC_BUS: {
         INITSTRUCT(sP_FE2CL_TRANSPORTATION_ENTER, enterBusData);
         enterBusData.AppearanceData = { 3, npc->appearanceData.iNPC_ID, npc->appearanceData.iNPCType, npc->appearanceData.iX, npc->appearanceData.iY, npc->appearanceData.iZ };
 
+        CNBroadcastPacket pkt((void*)&enterBusData, P_FE2CL_TRANSPORTATION_ENTER, sizeof(sP_FE2CL_TRANSPORTATION_ENTER));
         for (Chunk* chunk : chnks) {
             for (CNSocket* sock : chunk->players) {
                 // send to socket
-                sock->sendPacket((void*)&enterBusData, P_FE2CL_TRANSPORTATION_ENTER, sizeof(sP_FE2CL_TRANSPORTATION_ENTER));
+                sock->sendPacket(pkt);
                 npc->playersInView++;
             }
         }
         break;
-    case NPC_EGG:
+    }
+    case NPC_EGG: {
         INITSTRUCT(sP_FE2CL_SHINY_ENTER, enterEggData);
         Eggs::npcDataToEggData(&npc->appearanceData, &enterEggData.ShinyAppearanceData);
 
+        CNBroadcastPacket pkt((void*)&enterEggData, P_FE2CL_SHINY_ENTER, sizeof(sP_FE2CL_SHINY_ENTER));
         for (Chunk* chunk : chnks) {
             for (CNSocket* sock : chunk->players) {
                 // send to socket
-                sock->sendPacket((void*)&enterEggData, P_FE2CL_SHINY_ENTER, sizeof(sP_FE2CL_SHINY_ENTER));
+                sock->sendPacket(pkt);
                 npc->playersInView++;
             }
         }
         break;
-    default:
+    }
+    default: {
         // create struct
         INITSTRUCT(sP_FE2CL_NPC_ENTER, enterData);
         enterData.NPCAppearanceData = npc->appearanceData;
 
+        CNBroadcastPacket pkt((void*)&enterData, P_FE2CL_NPC_ENTER, sizeof(sP_FE2CL_NPC_ENTER));
         for (Chunk* chunk : chnks) {
             for (CNSocket* sock : chunk->players) {
                 // send to socket
-                sock->sendPacket((void*)&enterData, P_FE2CL_NPC_ENTER, sizeof(sP_FE2CL_NPC_ENTER));
+                sock->sendPacket(pkt);
                 npc->playersInView++;
             }
         }
         break;
     }
+    }
+
+    MobAI::updateActive(npc);
 }
 
-void Chunking::removePlayerFromChunks(std::set<Chunk*> chnks, CNSocket* sock) {
+void Chunking::removePlayerFromChunks(NearbyChunks chnks, CNSocket* sock) {
     INITSTRUCT(sP_FE2CL_PC_EXIT, exitPlayer);
 
     // for chunks that need the player to be removed from
@@ -220,6 +412,7 @@ void Chunking::removePlayerFromChunks(std::set<Chunk*> chnks, CNSocket* sock) {
         for (int32_t id : chunk->NPCs) {
             BaseNPC* npc = NPCManager::NPCs[id];
             npc->playersInView--;
+            MobAI::updateActive(npc);
 
             switch (npc->npcClass) {
             case NPC_BUS:
@@ -254,50 +447,58 @@ void Chunking::removePlayerFromChunks(std::set<Chunk*> chnks, CNSocket* sock) {
 
 }
 
-void Chunking::removeNPCFromChunks(std::set<Chunk*> chnks, int32_t id) {
+void Chunking::removeNPCFromChunks(NearbyChunks chnks, int32_t id) {
     BaseNPC* npc = NPCManager::NPCs[id];
 
     switch (npc->npcClass) {
-    case NPC_BUS:
+    case NPC_BUS: {
         INITSTRUCT(sP_FE2CL_TRANSPORTATION_EXIT, exitBusData);
         exitBusData.eTT = 3;
         exitBusData.iT_ID = id;
 
+        CNBroadcastPacket pkt((void*)&exitBusData, P_FE2CL_TRANSPORTATION_EXIT, sizeof(sP_FE2CL_TRANSPORTATION_EXIT));
         for (Chunk* chunk : chnks) {
             for (CNSocket* sock : chunk->players) {
                 // send to socket
-                sock->sendPacket((void*)&exitBusData, P_FE2CL_TRANSPORTATION_EXIT, sizeof(sP_FE2CL_TRANSPORTATION_EXIT));
+                sock->sendPacket(pkt);
                 npc->playersInView--;
             }
         }
         break;
-    case NPC_EGG:
+    }
+    case NPC_EGG: {
         INITSTRUCT(sP_FE2CL_SHINY_EXIT, exitEggData);
         exitEggData.iShinyID = id;
 
+        CNBroadcastPacket pkt((void*)&exitEggData, P_FE2CL_SHINY_EXIT, sizeof(sP_FE2CL_SHINY_EXIT));
         for (Chunk* chunk : chnks) {
             for (CNSocket* sock : chunk->players) {
                 // send to socket
-                sock->sendPacket((void*)&exitEggData, P_FE2CL_SHINY_EXIT, sizeof(sP_FE2CL_SHINY_EXIT));
+                sock->sendPacket(pkt);
                 npc->playersInView--;
             }
         }
         break;
-    default:
+    }
+    default: {
         // create struct
         INITSTRUCT(sP_FE2CL_NPC_EXIT, exitData);
         exitData.iNPC_ID = id;
 
         // remove it from the clients
+        CNBroadcastPacket pkt((void*)&exitData, P_FE2CL_NPC_EXIT, sizeof(sP_FE2CL_NPC_EXIT));
         for (Chunk* chunk : chnks) {
             for (CNSocket* sock : chunk->players) {
                 // send to socket
-                sock->sendPacket((void*)&exitData, P_FE2CL_NPC_EXIT, sizeof(sP_FE2CL_NPC_EXIT));
+                sock->sendPacket(pkt);
                 npc->playersInView--;
             }
         }
         break;
     }
+    }
+
+    MobAI::updateActive(npc);
 }
 
 static void emptyChunk(ChunkPos chunkPos) {
@@ -306,7 +507,7 @@ static void emptyChunk(ChunkPos chunkPos) {
         return; // chunk doesn't exist, we don't need to do anything
     }
 
-    Chunk* chunk = chunks[chunkPos];
+    Chunk* chunk = chunks.find(chunkPos);
 
     if (chunk->players.size() > 0) {
         std::cout << "[WARN] Tried to empty chunk that still had players\n";
@@ -314,16 +515,55 @@ static void emptyChunk(ChunkPos chunkPos) {
     }
 
     // unspawn all of the mobs/npcs
-    std::set npcIDs(chunk->NPCs);
+    std::vector<int32_t> npcIDs(chunk->NPCs);
     for (uint32_t id : npcIDs) {
         // every call of this will check if the chunk is empty and delete it if so
         NPCManager::destroyNPC(id);
     }
 }
 
+/*
+ * Adds every existing chunk in the 3x3 window around center that is not also
+ * in the window around other. Shared cells are skipped without a lookup.
+ */
+static void windowDifference(ChunkPos center, ChunkPos other, NearbyChunks& out) {
+    int x, y, otherX, otherY;
+    uint64_t inst, otherInst;
+    std::tie(x, y, inst) = center;
+    std::tie(otherX, otherY, otherInst) = other;
+
+    for (int i = -1; i < 2; i++) {
+        for (int z = -1; z < 2; z++) {
+            if (inst == otherInst && std::abs(x+i - otherX) <= 1 && std::abs(y+z - otherY) <= 1)
+                continue; // visible from both
+
+            Chunk* c = chunks.find(std::make_tuple(x+i, y+z, inst));
+            if (c != nullptr)
+                out.chunks[out.count++] = c;
+        }
+    }
+}
+
+/*
+ * Calculate diffs. This is done to prevent phasing on chunk borders.
+ * toExit will contain old viewables - new viewables, so the entity will only be exited in chunks that are out of sight.
+ * toEnter contains the opposite: new viewables - old viewables, chunks where we previously weren't visible from before.
+ *
+ * Both come straight from the positions of the two windows, so a one-chunk step only
+ * looks at the row/column on each edge, and teleports get the full windows.
+ */
+void Chunking::getViewableDelta(ChunkPos from, ChunkPos to, NearbyChunks& toExit, NearbyChunks& toEnter) {
+    windowDifference(from, to, toExit);
+    windowDifference(to, from, toEnter);
+}
+
 void Chunking::updatePlayerChunk(CNSocket* sock, ChunkPos from, ChunkPos to) {
     Player* plr = PlayerManager::getPlayer(sock);
 
+    // entities that haven't been placed yet have nothing in view to leave
+    bool placed = !plr->viewableChunks->empty();
+    Chunk* oldChunk = chunks.find(from);
+
     // if the new chunk doesn't exist, make it first
     if (!chunkExists(to))
         newChunk(to);
@@ -332,34 +572,33 @@ void Chunking::updatePlayerChunk(CNSocket* sock, ChunkPos from, ChunkPos to) {
     untrackPlayer(from, sock); // this will delete the chunk if it's empty
     trackPlayer(to, sock);
 
-    // calculate viewable chunks from both points
-    std::set<Chunk*> oldViewables = getViewableChunks(from);
-    std::set<Chunk*> newViewables = getViewableChunks(to);
-    std::set<Chunk*> toExit, toEnter;
-
-    /*
-     * Calculate diffs. This is done to prevent phasing on chunk borders.
-     * toExit will contain old viewables - new viewables, so the player will only be exited in chunks that are out of sight.
-     * toEnter contains the opposite: new viewables - old viewables, chunks where we previously weren't visible from before.
-     */
-    std::set_difference(oldViewables.begin(), oldViewables.end(), newViewables.begin(), newViewables.end(),
-        std::inserter(toExit, toExit.end())); // chunks we must be EXITed from (old - new)
-    std::set_difference(newViewables.begin(), newViewables.end(), oldViewables.begin(), oldViewables.end(),
-        std::inserter(toEnter, toEnter.end())); // chunks we must be ENTERed into (new - old)
+    NearbyChunks toExit, toEnter;
+    if (placed) {
+        getViewableDelta(from, to, toExit, toEnter);
+    } else {
+        toEnter = getViewableChunks(to);
+    }
 
     // update views
     removePlayerFromChunks(toExit, sock);
     addPlayerToChunks(toEnter, sock);
 
     plr->chunkPos = to; // update cached chunk position
-    // updated cached viewable chunks
-    plr->viewableChunks->clear();
-    plr->viewableChunks->insert(newViewables.begin(), newViewables.end());
+    // update cached viewable chunks
+    if (oldChunk != nullptr && !chunkExists(from))
+        plr->viewableChunks->erase(oldChunk); // deleted when we left it
+    for (Chunk* chunk : toExit)
+        plr->viewableChunks->erase(chunk);
+    plr->viewableChunks->insert(toEnter.begin(), toEnter.end());
 }
 
 void Chunking::updateNPCChunk(int32_t id, ChunkPos from, ChunkPos to) {
     BaseNPC* npc = NPCManager::NPCs[id];
 
+    // entities that haven't been placed yet have nothing in view to leave
+    bool placed = !npc->viewableChunks->empty();
+    Chunk* oldChunk = chunks.find(from);
+
     // if the new chunk doesn't exist, make it first
     if (!chunkExists(to))
         newChunk(to);
@@ -368,41 +607,36 @@ void Chunking::updateNPCChunk(int32_t id, ChunkPos from, ChunkPos to) {
     untrackNPC(from, id); // this will delete the chunk if it's empty
     trackNPC(to, id);
 
-    // calculate viewable chunks from both points
-    std::set<Chunk*> oldViewables = getViewableChunks(from);
-    std::set<Chunk*> newViewables = getViewableChunks(to);
-    std::set<Chunk*> toExit, toEnter;
-
-    /*
-     * Calculate diffs. This is done to prevent phasing on chunk borders.
-     * toExit will contain old viewables - new viewables, so the player will only be exited in chunks that are out of sight.
-     * toEnter contains the opposite: new viewables - old viewables, chunks where we previously weren't visible from before.
-     */
-    std::set_difference(oldViewables.begin(), oldViewables.end(), newViewables.begin(), newViewables.end(),
-        std::inserter(toExit, toExit.end())); // chunks we must be EXITed from (old - new)
-    std::set_difference(newViewables.begin(), newViewables.end(), oldViewables.begin(), oldViewables.end(),
-        std::inserter(toEnter, toEnter.end())); // chunks we must be ENTERed into (new - old)
+    NearbyChunks toExit, toEnter;
+    if (placed) {
+        getViewableDelta(from, to, toExit, toEnter);
+    } else {
+        toEnter = getViewableChunks(to);
+    }
 
     // update views
     removeNPCFromChunks(toExit, id);
     addNPCToChunks(toEnter, id);
 
     npc->chunkPos = to; // update cached chunk position
-    // updated cached viewable chunks
-    npc->viewableChunks->clear();
-    npc->viewableChunks->insert(newViewables.begin(), newViewables.end());
+    // update cached viewable chunks
+    if (oldChunk != nullptr && !chunkExists(from))
+        npc->viewableChunks->erase(oldChunk); // deleted when we left it
+    for (Chunk* chunk : toExit)
+        npc->viewableChunks->erase(chunk);
+    npc->viewableChunks->insert(toEnter.begin(), toEnter.end());
 }
 
 bool Chunking::chunkExists(ChunkPos chunk) {
-    return chunks.find(chunk) != chunks.end();
+    return chunks.find(chunk) != nullptr;
 }
 
 ChunkPos Chunking::chunkPosAt(int posX, int posY, uint64_t instanceID) {
     return std::make_tuple(posX / (settings::VIEWDISTANCE / 3), posY / (settings::VIEWDISTANCE / 3), instanceID);
 }
 
-std::set<Chunk*> Chunking::getViewableChunks(ChunkPos chunk) {
-    std::set<Chunk*> chnks;
+NearbyChunks Chunking::getViewableChunks(ChunkPos chunk) {
+    NearbyChunks chnks;
 
     int x, y;
     uint64_t inst;
@@ -411,28 +645,30 @@ std::set<Chunk*> Chunking::getViewableChunks(ChunkPos chunk) {
     // grabs surrounding chunks if they exist
     for (int i = -1; i < 2; i++) {
         for (int z = -1; z < 2; z++) {
-            ChunkPos pos = std::make_tuple(x+i, y+z, inst);
+            Chunk* c = chunks.find(std::make_tuple(x+i, y+z, inst));
 
-            // if chunk exists, add it to the set
-            if (chunkExists(pos))
-                chnks.insert(chunks[pos]);
+            // if chunk exists, add it to the list
+            if (c != nullptr)
+                chnks.chunks[chnks.count++] = c;
         }
     }
 
+    std::sort(chnks.begin(), chnks.end());
     return chnks;
 }
 
 /*
- * inefficient algorithm to get all chunks from a specific instance
+ * get the positions of all chunks in a specific instance
  */
 static std::vector<ChunkPos> getChunksInMap(uint64_t mapNum) {
     std::vector<ChunkPos> chnks;
 
-    for (auto it = chunks.begin(); it != chunks.end(); it++) {
-        if (std::get<2>(it->first) == mapNum) {
-            chnks.push_back(it->first);
-        }
-    }
+    auto it = instances.find(mapNum);
+    if (it == instances.end())
+        return chnks;
+
+    for (Chunk* chunk : it->second.chunks)
+        chnks.push_back(chunk->pos);
 
     return chnks;
 }
@@ -450,62 +686,85 @@ bool Chunking::inPopulatedChunks(std::set<Chunk*>* chnks) {
     return false;
 }
 
-void Chunking::createInstance(uint64_t instanceID) {
+static std::vector<TemplateSpawn>& getInstanceTemplate(uint64_t mapNum) {
+    auto it = instanceTemplates.find(mapNum);
+    if (it != instanceTemplates.end())
+        return it->second;
+
+    std::vector<TemplateSpawn>& spawns = instanceTemplates[mapNum];
+
+    for (ChunkPos& coords : getChunksInMap(mapNum)) {
+        for (int32_t npcID : chunks.find(coords)->NPCs) {
+            BaseNPC* baseNPC = NPCManager::NPCs[npcID];
 
-    std::vector<ChunkPos> templateChunks = getChunksInMap(MAPNUM(instanceID)); // base instance chunks
-    if (getChunksInMap(instanceID).size() == 0) { // only instantiate if the instance doesn't exist already
-        std::cout << "Creating instance " << instanceID << std::endl;
-        for (ChunkPos &coords : templateChunks) {
-            for (int npcID : chunks[coords]->NPCs) {
-                // make a copy of each NPC in the template chunks and put them in the new instance
-                BaseNPC* baseNPC = NPCManager::NPCs[npcID];
-                if (baseNPC->npcClass == NPC_MOB) {
-                    if (((Mob*)baseNPC)->groupLeader != 0 && ((Mob*)baseNPC)->groupLeader != npcID)
-                        continue; // follower; don't copy individually
-
-                    Mob* newMob = new Mob(baseNPC->appearanceData.iX, baseNPC->appearanceData.iY, baseNPC->appearanceData.iZ, baseNPC->appearanceData.iAngle,
-                        instanceID, baseNPC->appearanceData.iNPCType, NPCManager::NPCData[baseNPC->appearanceData.iNPCType], NPCManager::nextId++);
-                    NPCManager::NPCs[newMob->appearanceData.iNPC_ID] = newMob;
-                    MobAI::Mobs[newMob->appearanceData.iNPC_ID] = newMob;
-
-                    // if in a group, copy over group members as well
-                    if (((Mob*)baseNPC)->groupLeader != 0) {
-                        newMob->groupLeader = newMob->appearanceData.iNPC_ID; // set leader ID for new leader
-                        Mob* mobData = (Mob*)baseNPC;
-                        for (int i = 0; i < 4; i++) {
-                            if (mobData->groupMember[i] != 0) {
-                                int followerID = NPCManager::nextId++; // id for follower
-                                BaseNPC* baseFollower = NPCManager::NPCs[mobData->groupMember[i]]; // follower from template
-                                // new follower instance
-                                Mob* newMobFollower = new Mob(baseFollower->appearanceData.iX, baseFollower->appearanceData.iY, baseFollower->appearanceData.iZ, baseFollower->appearanceData.iAngle,
-                                    instanceID, baseFollower->appearanceData.iNPCType, NPCManager::NPCData[baseFollower->appearanceData.iNPCType], followerID);
-                                // add follower to NPC maps
-                                NPCManager::NPCs[followerID] = newMobFollower;
-                                MobAI::Mobs[followerID] = newMobFollower;
-                                // set follower-specific properties
-                                newMobFollower->groupLeader = newMob->appearanceData.iNPC_ID;
-                                newMobFollower->offsetX = ((Mob*)baseFollower)->offsetX;
-                                newMobFollower->offsetY = ((Mob*)baseFollower)->offsetY;
-                                // add follower copy to leader copy
-                                newMob->groupMember[i] = followerID;
-                                NPCManager::updateNPCPosition(followerID, baseFollower->appearanceData.iX, baseFollower->appearanceData.iY, baseFollower->appearanceData.iZ,
-                                    instanceID, baseFollower->appearanceData.iAngle);
-                            }
-                        }
-                    }
-                    NPCManager::updateNPCPosition(newMob->appearanceData.iNPC_ID, baseNPC->appearanceData.iX, baseNPC->appearanceData.iY, baseNPC->appearanceData.iZ,
-                        instanceID, baseNPC->appearanceData.iAngle);
-                } else {
-                    BaseNPC* newNPC = new BaseNPC(baseNPC->appearanceData.iX, baseNPC->appearanceData.iY, baseNPC->appearanceData.iZ, baseNPC->appearanceData.iAngle,
-                        instanceID, baseNPC->appearanceData.iNPCType, NPCManager::nextId++);
-                    NPCManager::NPCs[newNPC->appearanceData.iNPC_ID] = newNPC;
-                    NPCManager::updateNPCPosition(newNPC->appearanceData.iNPC_ID, baseNPC->appearanceData.iX, baseNPC->appearanceData.iY, baseNPC->appearanceData.iZ,
-                        instanceID, baseNPC->appearanceData.iAngle);
-                }
+            if (baseNPC->npcClass != NPC_MOB) {
+                spawns.push_back({baseNPC->appearanceData.iNPCType, baseNPC->appearanceData.iX, baseNPC->appearanceData.iY,
+                    baseNPC->appearanceData.iZ, baseNPC->appearanceData.iAngle, false, -1, 0, 0, 0});
+                continue;
+            }
+
+            Mob* mob = (Mob*)baseNPC;
+            if (mob->groupLeader != 0 && mob->groupLeader != npcID)
+                continue; // follower; added along with its leader
+
+            int leaderIndex = spawns.size();
+            spawns.push_back({mob->appearanceData.iNPCType, mob->spawnX, mob->spawnY, mob->spawnZ,
+                mob->appearanceData.iAngle, true, -1, 0, 0, 0});
+
+            if (mob->groupLeader == 0)
+                continue;
+
+            for (int i = 0; i < 4; i++) {
+                if (mob->groupMember[i] == 0)
+                    continue;
+
+                Mob* follower = (Mob*)NPCManager::NPCs[mob->groupMember[i]];
+                spawns.push_back({follower->appearanceData.iNPCType, follower->spawnX, follower->spawnY, follower->spawnZ,
+                    follower->appearanceData.iAngle, true, leaderIndex, i, follower->offsetX, follower->offsetY});
             }
         }
-    } else {
+    }
+
+    return spawns;
+}
+
+void Chunking::createInstance(uint64_t instanceID) {
+
+    if (instances.find(instanceID) != instances.end()) { // only instantiate if the instance doesn't exist already
         std::cout << "Instance " << instanceID << " already exists" << std::endl;
+        return;
+    }
+
+    std::vector<TemplateSpawn>& spawns = getInstanceTemplate(MAPNUM(instanceID));
+    std::cout << "Creating instance " << instanceID << std::endl;
+
+    // NPC IDs of this instance's copies, by spawn index
+    std::vector<int32_t> ids(spawns.size());
+
+    for (size_t i = 0; i < spawns.size(); i++) {
+        TemplateSpawn& spawn = spawns[i];
+        int32_t id = ids[i] = NPCManager::nextId++;
+
+        if (spawn.isMob) {
+            Mob* newMob = new Mob(spawn.x, spawn.y, spawn.z, spawn.angle, instanceID, spawn.type, &MobAI::MobTemplates[spawn.type], id);
+            NPCManager::NPCs[id] = newMob;
+            MobAI::Mobs[id] = newMob;
+
+            // leaders always come before their followers
+            if (spawn.leader != -1) {
+                Mob* leader = MobAI::Mobs[ids[spawn.leader]];
+                leader->groupLeader = leader->appearanceData.iNPC_ID;
+                leader->groupMember[spawn.memberSlot] = id;
+
+                newMob->groupLeader = leader->appearanceData.iNPC_ID;
+                newMob->offsetX = spawn.offsetX;
+                newMob->offsetY = spawn.offsetY;
+            }
+        } else {
+            NPCManager::NPCs[id] = new BaseNPC(spawn.x, spawn.y, spawn.z, spawn.angle, instanceID, spawn.type, id);
+        }
+
+        NPCManager::updateNPCPosition(id, spawn.x, spawn.y, spawn.z, instanceID, spawn.angle);
     }
 }
 
@@ -522,14 +781,9 @@ void Chunking::destroyInstanceIfEmpty(uint64_t instanceID) {
     if (PLAYERID(instanceID) == 0)
         return; // don't clean up overworld/IZ chunks
 
-    std::vector<ChunkPos> sourceChunkCoords = getChunksInMap(instanceID);
-
-    for (ChunkPos& coords : sourceChunkCoords) {
-        Chunk* chunk = chunks[coords];
-
-        if (chunk->players.size() > 0)
-            return; // there are still players inside
-    }
+    auto it = instances.find(instanceID);
+    if (it == instances.end() || it->second.players > 0)
+        return; // already gone, or there are still players inside
 
     destroyInstance(instanceID);
 }
@@ -1,17 +1,79 @@
 #pragma once
 
 #include "core/Core.hpp"
+#include "core/SlabPool.hpp"
 
 #include <utility>
 #include <set>
 #include <map>
 #include <tuple>
+#include <vector>
 #include <algorithm>
 
+/*
+ * Members are kept in plain arrays; chunks rarely hold more than a few dozen
+ * entities, so a linear scan + swap-remove beats a tree on every operation.
+ * Order is not preserved.
+ */
 class Chunk {
 public:
-    std::set<CNSocket*> players;
-    std::set<int32_t> NPCs;
+    std::vector<CNSocket*> players;
+    std::vector<int32_t> NPCs;
+
+    ChunkPos pos;
+    size_t instanceIndex; // position in its instance's chunk list
+
+    // chunks come and go all the time at borders and in lairs; see SlabPool
+    static void* operator new(size_t size);
+    static void operator delete(void* p, size_t size);
+};
+
+/*
+ * The (up to) 9 chunks surrounding a chunk, kept on the stack.
+ * Sorted by address so it can be fed to the <algorithm> set operations.
+ */
+struct NearbyChunks {
+    Chunk* chunks[9];
+    int count = 0;
+
+    Chunk** begin() { return chunks; }
+    Chunk** end() { return chunks + count; }
+    bool empty() { return count == 0; }
+};
+
+/*
+ * Open-addressing (linear probing) hash table of every chunk in the world.
+ * Chunk coordinates are packed into a single word and hashed together with the instance ID.
+ */
+class ChunkMap {
+private:
+    struct Slot {
+        uint64_t xy;
+        uint64_t instance;
+        Chunk* chunk; // nullptr for empty slots
+    };
+
+    std::vector<Slot> slots; // size is always a power of two
+    size_t count = 0;
+
+    size_t probe(uint64_t xy, uint64_t instance);
+    void grow();
+
+public:
+    ChunkMap();
+
+    Chunk* find(ChunkPos pos);
+    void insert(ChunkPos pos, Chunk* chunk);
+    void erase(ChunkPos pos);
+    size_t size() { return count; }
+
+    template<class F>
+    void forEach(F fn) {
+        for (Slot& slot : slots) {
+            if (slot.chunk != nullptr)
+                fn(std::make_tuple((int)(slot.xy >> 32), (int)(uint32_t)slot.xy, slot.instance), slot.chunk);
+        }
+    }
 };
 
 enum {
@@ -21,7 +83,9 @@ enum {
 };
 
 namespace Chunking {
-    extern std::map<ChunkPos, Chunk*> chunks;
+    extern ChunkMap chunks;
+    // every player's and NPC's viewableChunks set comes from here
+    extern ObjectPool<std::set<Chunk*>> ViewableSets;
 
     void updatePlayerChunk(CNSocket* sock, ChunkPos from, ChunkPos to);
     void updateNPCChunk(int32_t id, ChunkPos from, ChunkPos to);
@@ -31,14 +95,15 @@ namespace Chunking {
     void untrackPlayer(ChunkPos chunkPos, CNSocket* sock);
     void untrackNPC(ChunkPos chunkPos, int32_t id);
 
-    void addPlayerToChunks(std::set<Chunk*> chnks, CNSocket* sock);
-    void addNPCToChunks(std::set<Chunk*> chnks, int32_t id);
-    void removePlayerFromChunks(std::set<Chunk*> chnks, CNSocket* sock);
-    void removeNPCFromChunks(std::set<Chunk*> chnks, int32_t id);
+    void addPlayerToChunks(NearbyChunks chnks, CNSocket* sock);
+    void addNPCToChunks(NearbyChunks chnks, int32_t id);
+    void removePlayerFromChunks(NearbyChunks chnks, CNSocket* sock);
+    void removeNPCFromChunks(NearbyChunks chnks, int32_t id);
 
     bool chunkExists(ChunkPos chunk);
     ChunkPos chunkPosAt(int posX, int posY, uint64_t instanceID);
-    std::set<Chunk*> getViewableChunks(ChunkPos chunkPos);
+    NearbyChunks getViewableChunks(ChunkPos chunkPos);
+    void getViewableDelta(ChunkPos from, ChunkPos to, NearbyChunks& toExit, NearbyChunks& toEnter);
 
     bool inPopulatedChunks(std::set<Chunk*>* chnks);
     void createInstance(uint64_t);
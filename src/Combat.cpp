@@ -118,8 +118,8 @@ static void pcAttackNpcs(CNSocket *sock, CNPacketData *data) {
         else
             damage.first = plr->pointDamage;
 
-        int difficulty = (int)mob->data["m_iNpcLevel"];
-        damage = getDamage(damage.first, (int)mob->data["m_iProtection"], true, (plr->batteryW > 6 + difficulty), Nanos::nanoStyle(plr->activeNano), (int)mob->data["m_iNpcStyle"], difficulty);
+        int difficulty = mob->data->level;
+        damage = getDamage(damage.first, mob->data->protection, true, (plr->batteryW > 6 + difficulty), Nanos::nanoStyle(plr->activeNano), mob->data->style, difficulty);
         
         if (plr->batteryW >= 6 + difficulty)
             plr->batteryW -= 6 + difficulty;
@@ -148,7 +148,8 @@ static void pcAttackNpcs(CNSocket *sock, CNPacketData *data) {
 }
 
 void Combat::npcAttackPc(Mob *mob, time_t currTime) {
-    Player *plr = PlayerManager::getPlayer(mob->target);
+    CNSocket *sock = PlayerManager::getSockFromHandle(mob->target);
+    Player *plr = PlayerManager::getPlayer(sock);
 
     const size_t resplen = sizeof(sP_FE2CL_PC_ATTACK_NPCs_SUCC) + sizeof(sAttackResult);
     assert(resplen < CN_PACKET_BUFFER_SIZE - 8);
@@ -158,7 +159,7 @@ void Combat::npcAttackPc(Mob *mob, time_t currTime) {
     sP_FE2CL_NPC_ATTACK_PCs *pkt = (sP_FE2CL_NPC_ATTACK_PCs*)respbuf;
     sAttackResult *atk = (sAttackResult*)(respbuf + sizeof(sP_FE2CL_NPC_ATTACK_PCs));
 
-    auto damage = getDamage(450 + (int)mob->data["m_iPower"], plr->defense, false, false, -1, -1, 0);
+    auto damage = getDamage(450 + mob->data->power, plr->defense, false, false, -1, -1, 0);
 
     if (!(plr->iSpecialState & CN_SPECIAL_STATE_FLAG__INVULNERABLE))
         plr->HP -= damage.first;
@@ -171,11 +172,11 @@ void Combat::npcAttackPc(Mob *mob, time_t currTime) {
     atk->iHP = plr->HP;
     atk->iHitFlag = damage.second;
 
-    mob->target->sendPacket((void*)respbuf, P_FE2CL_NPC_ATTACK_PCs, resplen);
-    PlayerManager::sendToViewable(mob->target, (void*)respbuf, P_FE2CL_NPC_ATTACK_PCs, resplen);
+    sock->sendPacket((void*)respbuf, P_FE2CL_NPC_ATTACK_PCs, resplen);
+    PlayerManager::sendToViewable(sock, (void*)respbuf, P_FE2CL_NPC_ATTACK_PCs, resplen);
 
     if (plr->HP <= 0) {
-        mob->target = nullptr;
+        mob->target = {};
         mob->state = MobState::RETREAT;
         if (!MobAI::aggroCheck(mob, currTime)) {
             MobAI::clearDebuff(mob);
@@ -195,7 +196,7 @@ int Combat::hitMob(CNSocket *sock, Mob *mob, int damage) {
         return 0; // don't hurt a mob casting corruption
 
     if (mob->state == MobState::ROAMING) {
-        assert(mob->target == nullptr);
+        assert(mob->target.isNull());
         MobAI::enterCombat(sock, mob);
 
         if (mob->groupLeader != 0)
@@ -216,14 +217,15 @@ int Combat::hitMob(CNSocket *sock, Mob *mob, int damage) {
     }
 
     if (mob->appearanceData.iHP <= 0)
-        killMob(mob->target, mob);
+        killMob(PlayerManager::getSockFromHandle(mob->target), mob);
 
     return damage;
 }
 
 void Combat::killMob(CNSocket *sock, Mob *mob) {
     mob->state = MobState::DEAD;
-    mob->target = nullptr;
+    MobAI::wake(mob); // dead mobs still need to respawn, even if nobody's around
+    mob->target = {};
     mob->appearanceData.iConditionBitFlag = 0;
     mob->skillStyle = -1;
     mob->unbuffTimes.clear();
@@ -469,10 +471,10 @@ static void pcAttackChars(CNSocket *sock, CNPacketData *data) {
             else
                 damage.first = plr->pointDamage;
 
-            int difficulty = (int)mob->data["m_iNpcLevel"];
+            int difficulty = mob->data->level;
 
-            damage = getDamage(damage.first, (int)mob->data["m_iProtection"], true, (plr->batteryW > 6 + difficulty),
-                Nanos::nanoStyle(plr->activeNano), (int)mob->data["m_iNpcStyle"], difficulty);
+            damage = getDamage(damage.first, mob->data->protection, true, (plr->batteryW > 6 + difficulty),
+                Nanos::nanoStyle(plr->activeNano), mob->data->style, difficulty);
 
             if (plr->batteryW >= 6 + difficulty)
                 plr->batteryW -= 6 + difficulty;
@@ -666,8 +668,8 @@ static void projectileHit(CNSocket* sock, CNPacketData* data) {
 
         damage.first = pkt->iTargetCnt > 1 ? bullet->groupDamage : bullet->pointDamage;
 
-        int difficulty = (int)mob->data["m_iNpcLevel"];
-        damage = getDamage(damage.first, (int)mob->data["m_iProtection"], true, bullet->weaponBoost, Nanos::nanoStyle(plr->activeNano), (int)mob->data["m_iNpcStyle"], difficulty);
+        int difficulty = mob->data->level;
+        damage = getDamage(damage.first, mob->data->protection, true, bullet->weaponBoost, Nanos::nanoStyle(plr->activeNano), mob->data->style, difficulty);
 
         damage.first = hitMob(sock, mob, damage.first);
 
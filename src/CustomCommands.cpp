@@ -312,8 +312,9 @@ static void toggleAiCommand(std::string full, std::vector<std::string>& args, CN
     // return all mobs to their spawn points
     for (auto& pair : MobAI::Mobs) {
         pair.second->state = MobState::RETREAT;
-        pair.second->target = nullptr;
+        pair.second->target = {};
         pair.second->nextMovement = getTime();
+        MobAI::wake(pair.second);
 
         // mobs with static paths can chill where they are
         if (pair.second->staticPath) {
@@ -440,18 +441,18 @@ static void minfoCommand(std::string full, std::vector<std::string>& args, CNSoc
     for (int i = 0; i < ACTIVE_MISSION_COUNT; i++) {
         if (plr->tasks[i] != 0) {
             TaskData& task = *Missions::Tasks[plr->tasks[i]];
-            if ((int)(task["m_iHMissionID"]) == plr->CurrentMissionID) {
+            if (task.missionID == plr->CurrentMissionID) {
                 Chat::sendServerMessage(sock, "[MINFO] Current task ID: " + std::to_string(plr->tasks[i]));
-                Chat::sendServerMessage(sock, "[MINFO] Current task type: " + std::to_string((int)(task["m_iHTaskType"])));
-                Chat::sendServerMessage(sock, "[MINFO] Current waypoint NPC ID: " + std::to_string((int)(task["m_iSTGrantWayPoint"])));
-                Chat::sendServerMessage(sock, "[MINFO] Current terminator NPC ID: " + std::to_string((int)(task["m_iHTerminatorNPCID"])));
+                Chat::sendServerMessage(sock, "[MINFO] Current task type: " + std::to_string(task.taskType));
+                Chat::sendServerMessage(sock, "[MINFO] Current waypoint NPC ID: " + std::to_string(task.waypointNPC));
+                Chat::sendServerMessage(sock, "[MINFO] Current terminator NPC ID: " + std::to_string(task.terminatorNPC));
 
-                if ((int)(task["m_iSTGrantTimer"]) != 0)
-                    Chat::sendServerMessage(sock, "[MINFO] Current task timer: " + std::to_string((int)(task["m_iSTGrantTimer"])));
+                if (task.timeLimit != 0)
+                    Chat::sendServerMessage(sock, "[MINFO] Current task timer: " + std::to_string(task.timeLimit));
 
                 for (int j = 0; j < 3; j++)
-                    if ((int)(task["m_iCSUEnemyID"][j]) != 0)
-                        Chat::sendServerMessage(sock, "[MINFO] Current task mob #" + std::to_string(j+1) +": " + std::to_string((int)(task["m_iCSUEnemyID"][j])));
+                    if (task.enemyIDs[j] != 0)
+                        Chat::sendServerMessage(sock, "[MINFO] Current task mob #" + std::to_string(j+1) +": " + std::to_string(task.enemyIDs[j]));
 
                 return;
             }
@@ -466,7 +467,7 @@ static void tasksCommand(std::string full, std::vector<std::string>& args, CNSoc
     for (int i = 0; i < ACTIVE_MISSION_COUNT; i++) {
         if (plr->tasks[i] != 0) {
             TaskData& task = *Missions::Tasks[plr->tasks[i]];
-            Chat::sendServerMessage(sock, "[TASK-" + std::to_string(i) + "] mission ID: " + std::to_string((int)(task["m_iHMissionID"])));
+            Chat::sendServerMessage(sock, "[TASK-" + std::to_string(i) + "] mission ID: " + std::to_string(task.missionID));
             Chat::sendServerMessage(sock, "[TASK-" + std::to_string(i) + "] task ID: " + std::to_string(plr->tasks[i]));
         }
     }
@@ -648,6 +649,25 @@ static void flushCommand(std::string full, std::vector<std::string>& args, CNSoc
     Chat::sendServerMessage(sock, "Wrote gruntwork to " + settings::GRUNTWORKJSON);
 }
 
+static void dbstatsCommand(std::string full, std::vector<std::string>& args, CNSocket* sock) {
+    Database::printStatementStats();
+    Database::printLockStats();
+    Chat::sendServerMessage(sock, "Printed DB stats to the server console");
+}
+
+static void poolstatsCommand(std::string full, std::vector<std::string>& args, CNSocket* sock) {
+    for (SlabPool* pool : SlabPool::all()) {
+        SlabPool::Stats stats = pool->stats();
+        std::string line = "[POOL] " + pool->name + ": " + std::to_string(stats.live) + " live (peak " + std::to_string(stats.peak) + "), "
+            + std::to_string(stats.slabs) + " slabs (" + std::to_string(stats.bytes / 1024) + " KiB), "
+            + std::to_string(stats.allocs) + " allocs";
+        if (stats.oversized > 0)
+            line += ", " + std::to_string(stats.oversized) + " oversized";
+
+        Chat::sendServerMessage(sock, line);
+    }
+}
+
 static void whoisCommand(std::string full, std::vector<std::string>& args, CNSocket* sock) {
     Player* plr = PlayerManager::getPlayer(sock);
     BaseNPC* npc = NPCManager::getNearestNPC(plr->viewableChunks, plr->x, plr->y, plr->z);
@@ -674,10 +694,10 @@ static void whoisCommand(std::string full, std::vector<std::string>& args, CNSoc
 
 static void lairUnlockCommand(std::string full, std::vector<std::string>& args, CNSocket* sock) {
     Player* plr = PlayerManager::getPlayer(sock);
-    if (!Chunking::chunkExists(plr->chunkPos))
+    Chunk* chnk = Chunking::chunks.find(plr->chunkPos);
+    if (chnk == nullptr)
         return;
 
-    Chunk* chnk = Chunking::chunks[plr->chunkPos];
     int taskID = -1;
     int missionID = -1;
     int found = 0;
@@ -689,7 +709,7 @@ static void lairUnlockCommand(std::string full, std::vector<std::string>& args,
         for (auto it = NPCManager::Warps.begin(); it != NPCManager::Warps.end(); it++) {
             if ((*it).second.npcID == npc->appearanceData.iNPCType) {
                 taskID = (*it).second.limitTaskID;
-                missionID = Missions::Tasks[taskID]->task["m_iHMissionID"];
+                missionID = Missions::Tasks[taskID]->missionID;
                 found++;
                 break;
             }
@@ -949,6 +969,8 @@ void CustomCommands::init() {
     registerCommand("unsummonW", 30, unsummonWCommand, "delete permanently summoned NPCs");
     registerCommand("toggleai", 30, toggleAiCommand, "enable/disable mob AI");
     registerCommand("flush", 30, flushCommand, "save gruntwork to file");
+    registerCommand("dbstats", 30, dbstatsCommand, "print DB statement and lock timings to the server console");
+    registerCommand("poolstats", 30, poolstatsCommand, "show how much memory the entity pools are holding");
     registerCommand("level", 50, levelCommand, "change your character's level");
     registerCommand("levelx", 50, levelCommand, "change your character's level"); // for Academy
     registerCommand("population", 100, populationCommand, "check how many players are online");
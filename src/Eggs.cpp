@@ -1,3 +1,4 @@
+#include "servers/CNShardServer.hpp"
 #include "core/Core.hpp"
 #include "Eggs.hpp"
 #include "PlayerManager.hpp"
@@ -15,6 +16,16 @@ std::map<std::pair<CNSocket*, int32_t>, time_t> Eggs::EggBuffs;
 std::unordered_map<int, EggType> Eggs::EggTypes;
 std::unordered_map<int, Egg*> Eggs::Eggs;
 
+static SlabPool eggPool("Egg", sizeof(Egg));
+
+void* Egg::operator new(size_t size) {
+    return eggPool.alloc(size);
+}
+
+void Egg::operator delete(void* p, size_t size) {
+    eggPool.free(p, size);
+}
+
 int Eggs::eggBuffPlayer(CNSocket* sock, int skillId, int eggId, int duration) {
     Player* plr = PlayerManager::getPlayer(sock);
     Player* otherPlr = PlayerManager::getPlayerFromID(plr->iIDGroup);
@@ -76,52 +87,56 @@ int Eggs::eggBuffPlayer(CNSocket* sock, int skillId, int eggId, int duration) {
     if (CBFlag == 0)
         return -1;
 
+    addEggBuff(sock, CBFlag, getTime() + (time_t)duration * 1000);
+
+    return 0;
+}
+
+static void expireEggBuff(std::pair<CNSocket*, int32_t> key, time_t currTime) {
+    // the buff may have been refreshed since this was scheduled, or the player may have left
+    auto it = EggBuffs.find(key);
+    if (it == EggBuffs.end() || it->second > currTime)
+        return;
+
+    CNSocket* sock = key.first;
+    int32_t CBFlag = key.second;
+    Player* plr = PlayerManager::getPlayer(sock);
+    Player* otherPlr = PlayerManager::getPlayerFromID(plr->iIDGroup);
+
+    int groupFlags = Groups::getGroupFlags(otherPlr);
+    for (auto& pwr : Nanos::NanoPowers) {
+        if (pwr.bitFlag == CBFlag) { // pick the power with the right flag and unbuff
+            INITSTRUCT(sP_FE2CL_PC_BUFF_UPDATE, resp);
+            resp.eCSTB = pwr.timeBuffID;
+            resp.eTBU = 2;
+            resp.eTBT = 3; // for egg buffs
+            plr->iConditionBitFlag &= ~CBFlag;
+            resp.iConditionBitFlag = plr->iConditionBitFlag |= groupFlags | plr->iSelfConditionBitFlag;
+            sock->sendPacket((void*)&resp, P_FE2CL_PC_BUFF_UPDATE, sizeof(sP_FE2CL_PC_BUFF_UPDATE));
+
+            INITSTRUCT(sP_FE2CL_CHAR_TIME_BUFF_TIME_OUT, resp2); // send a buff timeout to other players
+            resp2.eCT = 1;
+            resp2.iID = plr->iID;
+            resp2.iConditionBitFlag = plr->iConditionBitFlag;
+            PlayerManager::sendToViewable(sock, (void*)&resp2, P_FE2CL_CHAR_TIME_BUFF_TIME_OUT, sizeof(sP_FE2CL_CHAR_TIME_BUFF_TIME_OUT));
+        }
+    }
+
+    // remove buff from the map
+    EggBuffs.erase(it);
+}
+
+void Eggs::addEggBuff(CNSocket* sock, int32_t CBFlag, time_t until) {
     std::pair<CNSocket*, int32_t> key = std::make_pair(sock, CBFlag);
 
-    // save the buff serverside;
-    // if you get the same buff again, new duration will override the previous one
-    time_t until = getTime() + (time_t)duration * 1000;
+    // if you get the same buff again, new duration will override the previous one;
+    // the old timer still fires, but sees the later expiry and leaves it alone
     EggBuffs[key] = until;
-
-    return 0;
+    CNShardServer::Wheel.schedule(until, [key](time_t currTime) { expireEggBuff(key, currTime); });
 }
 
 static void eggStep(CNServer* serv, time_t currTime) {
-    // tick buffs
     time_t timeStamp = currTime;
-    auto it = EggBuffs.begin();
-    while (it != EggBuffs.end()) {
-        // check remaining time
-        if (it->second > timeStamp)
-            it++;
-        else { // if time reached 0
-            CNSocket* sock = it->first.first;
-            int32_t CBFlag = it->first.second;
-            Player* plr = PlayerManager::getPlayer(sock);
-            Player* otherPlr = PlayerManager::getPlayerFromID(plr->iIDGroup);
-
-            int groupFlags = Groups::getGroupFlags(otherPlr);
-            for (auto& pwr : Nanos::NanoPowers) {
-                if (pwr.bitFlag == CBFlag) { // pick the power with the right flag and unbuff
-                    INITSTRUCT(sP_FE2CL_PC_BUFF_UPDATE, resp);
-                    resp.eCSTB = pwr.timeBuffID;
-                    resp.eTBU = 2;
-                    resp.eTBT = 3; // for egg buffs
-                    plr->iConditionBitFlag &= ~CBFlag;
-                    resp.iConditionBitFlag = plr->iConditionBitFlag |= groupFlags | plr->iSelfConditionBitFlag;
-                    sock->sendPacket((void*)&resp, P_FE2CL_PC_BUFF_UPDATE, sizeof(sP_FE2CL_PC_BUFF_UPDATE));
-
-                    INITSTRUCT(sP_FE2CL_CHAR_TIME_BUFF_TIME_OUT, resp2); // send a buff timeout to other players
-                    resp2.eCT = 1;
-                    resp2.iID = plr->iID;
-                    resp2.iConditionBitFlag = plr->iConditionBitFlag;
-                    PlayerManager::sendToViewable(sock, (void*)&resp2, P_FE2CL_CHAR_TIME_BUFF_TIME_OUT, sizeof(sP_FE2CL_CHAR_TIME_BUFF_TIME_OUT));
-                }
-            }
-            // remove buff from the map
-            it = EggBuffs.erase(it);
-        }
-    }
 
     // check dead eggs and eggs in inactive chunks
     for (auto egg : Eggs::Eggs) {
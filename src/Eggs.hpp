@@ -13,6 +13,9 @@ struct Egg : public BaseNPC {
         summoned = summon;
         npcClass = NPCClass::NPC_EGG;
     }
+
+    static void* operator new(size_t size);
+    static void operator delete(void* p, size_t size);
 };
 
 struct EggType {
@@ -31,5 +34,7 @@ namespace Eggs {
 
     /// returns -1 on fail
     int eggBuffPlayer(CNSocket* sock, int skillId, int eggId, int duration);
+    /// saves the buff serverside and schedules its removal; getting the same buff again overrides the old expiry
+    void addEggBuff(CNSocket* sock, int32_t CBFlag, time_t until);
     void npcDataToEggData(sNPCAppearanceData* npc, sShinyAppearanceData* egg);
 }
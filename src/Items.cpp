@@ -415,9 +415,7 @@ static void itemUseHandler(CNSocket* sock, CNPacketData* data) {
         // update inventory serverside
         player->Inven[resp->iSlotNum] = resp->RemainItem;
 
-        std::pair<CNSocket*, int32_t> key = std::make_pair(sock, value1);
-        time_t until = getTime() + (time_t)Nanos::SkillTable[144].durationTime[0] * 100;
-        Eggs::EggBuffs[key] = until;
+        Eggs::addEggBuff(sock, value1, getTime() + (time_t)Nanos::SkillTable[144].durationTime[0] * 100);
     } else {
         INITSTRUCT(sP_FE2CL_REP_PC_ITEM_USE_SUCC, resp);
         resp.iPC_ID = player->iID;
@@ -6,10 +6,13 @@
 
 #include "string.h"
 
+#include <algorithm>
+
 using namespace Missions;
 
 std::map<int32_t, Reward*> Missions::Rewards;
 std::map<int32_t, TaskData*> Missions::Tasks;
+std::unordered_map<int32_t, std::vector<int32_t>> Missions::EnemyTasks;
 nlohmann::json Missions::AvatarGrowth[37];
 
 static void saveMission(Player* player, int missionId) {
@@ -248,17 +251,17 @@ static bool endTask(CNSocket *sock, int32_t taskNum, int choice=0) {
      */
 
     for (int i = 0; i < 3; i++)
-        if (task["m_iSUItem"][i] != 0)
-            dropQuestItem(sock, taskNum, task["m_iSUInstancename"][i], task["m_iSUItem"][i], 0);
+        if (task.endItemIDs[i] != 0)
+            dropQuestItem(sock, taskNum, task.endItemCounts[i], task.endItemIDs[i], 0);
 
     // if it's the last task
-    if (task["m_iSUOutgoingTask"] == 0) {
+    if (task.nextTask == 0) {
         // save completed mission on player
-        saveMission(plr, (int)(task["m_iHMissionID"])-1);
+        saveMission(plr, task.missionID - 1);
 
         // if it's a nano mission, reward the nano.
-        if (task["m_iSTNanoID"] != 0)
-            Nanos::addNano(sock, task["m_iSTNanoID"], 0, true);
+        if (task.nanoID != 0)
+            Nanos::addNano(sock, task.nanoID, 0, true);
 
         // remove current mission
         plr->CurrentMissionID = 0;
@@ -276,7 +279,7 @@ bool Missions::startTask(Player* plr, int TaskID) {
     TaskData& task = *Missions::Tasks[TaskID];
 
     // client freaks out if nano mission isn't sent first after relogging, so it's easiest to set it here
-    if (task["m_iSTNanoID"] != 0 && plr->tasks[0] != 0) {
+    if (task.nanoID != 0 && plr->tasks[0] != 0) {
             // lets move task0 to different spot
             int moveToSlot = 1;
             for (; moveToSlot < ACTIVE_MISSION_COUNT; moveToSlot++)
@@ -296,7 +299,7 @@ bool Missions::startTask(Player* plr, int TaskID) {
         if (plr->tasks[i] == 0) {
             plr->tasks[i] = TaskID;
             for (int j = 0; j < 3; j++) {
-                plr->RemainingNPCCount[i][j] = (int)task["m_iCSUNumToKill"][j];
+                plr->RemainingNPCCount[i][j] = task.killCounts[j];
             }
             break;
         }
@@ -329,15 +332,15 @@ static void taskStart(CNSocket* sock, CNPacketData* data) {
 
     // Give player their delivery items at the start, or reset them to 0 at the start.
     for (int i = 0; i < 3; i++)
-        if (task["m_iSTItemID"][i] != 0)
-            dropQuestItem(sock, missionData->iTaskNum, task["m_iSTItemNumNeeded"][i], task["m_iSTItemID"][i], 0);
+        if (task.startItemIDs[i] != 0)
+            dropQuestItem(sock, missionData->iTaskNum, task.startItemCounts[i], task.startItemIDs[i], 0);
     std::cout << "Mission requested task: " << missionData->iTaskNum << std::endl;
     response.iTaskNum = missionData->iTaskNum;
-    response.iRemainTime = task["m_iSTGrantTimer"];
+    response.iRemainTime = task.timeLimit;
     sock->sendPacket((void*)&response, P_FE2CL_REP_PC_TASK_START_SUCC, sizeof(sP_FE2CL_REP_PC_TASK_START_SUCC));
 
     // HACK: auto-succeed escort task
-    if (task["m_iHTaskType"] == 6) {
+    if (task.taskType == 6) {
         std::cout << "Skipping escort mission" << std::endl;
         INITSTRUCT(sP_FE2CL_REP_PC_TASK_END_SUCC, response);
 
@@ -357,7 +360,7 @@ static void taskEnd(CNSocket* sock, CNPacketData* data) {
     // failed timed missions give an iNPC_ID of 0
     if (missionData->iNPC_ID == 0) {
         TaskData* task = Missions::Tasks[missionData->iTaskNum];
-        if (task->task["m_iSTGrantTimer"] > 0) { // its a timed mission
+        if (task->timeLimit > 0) { // its a timed mission
             Player* plr = PlayerManager::getPlayer(sock);
             /*
              * Enemy killing missions
@@ -365,7 +368,7 @@ static void taskEnd(CNSocket* sock, CNPacketData* data) {
              * once we comb over mission logic more throughly
              */
             bool mobsAreKilled = false;
-            if (task->task["m_iHTaskType"] == 5) {
+            if (task->taskType == 5) {
                 mobsAreKilled = true;
                 for (int i = 0; i < ACTIVE_MISSION_COUNT; i++) {
                     if (plr->tasks[i] == missionData->iTaskNum) {
@@ -381,7 +384,7 @@ static void taskEnd(CNSocket* sock, CNPacketData* data) {
 
             if (!mobsAreKilled) {
                 
-                int failTaskID = task->task["m_iFOutgoingTask"];
+                int failTaskID = task->failTask;
                 if (failTaskID != 0) {
                     Missions::quitTask(sock, missionData->iTaskNum, false);
                     
@@ -454,7 +457,7 @@ void Missions::quitTask(CNSocket* sock, int32_t taskNum, bool manual) {
     // clean up quest items
     if (manual) {
         for (i = 0; i < 3; i++) {
-            if (task["m_iSUItem"][i] == 0 && task["m_iCSUItemID"][i] == 0)
+            if (task.endItemIDs[i] == 0 && task.dropItemIDs[i] == 0)
                 continue;
 
             /*
@@ -462,7 +465,7 @@ void Missions::quitTask(CNSocket* sock, int32_t taskNum, bool manual) {
              * slot later items will be placed in.
              */
             for (int j = 0; j < AQINVEN_COUNT; j++)
-                if (plr->QInven[j].iID == task["m_iSUItem"][i] || plr->QInven[j].iID == task["m_iCSUItemID"][i] || plr->QInven[j].iID == task["m_iSTItemID"][i])
+                if (plr->QInven[j].iID == task.endItemIDs[i] || plr->QInven[j].iID == task.dropItemIDs[i] || plr->QInven[j].iID == task.startItemIDs[i])
                     memset(&plr->QInven[j], 0, sizeof(sItemBase));
         }
     } else {
@@ -506,7 +509,7 @@ void Missions::updateFusionMatter(CNSocket* sock, int fusion) {
     // check if the nano task is already started
     for (int i = 0; i < ACTIVE_MISSION_COUNT; i++) {
         TaskData& task = *Tasks[plr->tasks[i]];
-        if (task["m_iSTNanoID"] != 0)
+        if (task.nanoID != 0)
             return; // nano mission was already started!
     }
 
@@ -539,6 +542,12 @@ void Missions::updateFusionMatter(CNSocket* sock, int fusion) {
 }
 
 void Missions::mobKilled(CNSocket *sock, int mobid, int rolledQItem) {
+    // most mobs aren't part of any task
+    auto it = EnemyTasks.find(mobid);
+    if (it == EnemyTasks.end())
+        return;
+
+    std::vector<int32_t>& interested = it->second;
     Player *plr = PlayerManager::getPlayer(sock);
 
     bool missionmob = false;
@@ -547,26 +556,29 @@ void Missions::mobKilled(CNSocket *sock, int mobid, int rolledQItem) {
         if (plr->tasks[i] == 0)
             continue;
 
+        if (std::find(interested.begin(), interested.end(), plr->tasks[i]) == interested.end())
+            continue;
+
         // tasks[] should always have valid IDs
         TaskData& task = *Tasks[plr->tasks[i]];
 
         for (int j = 0; j < 3; j++) {
-            if (task["m_iCSUEnemyID"][j] != mobid)
+            if (task.enemyIDs[j] != mobid)
                 continue;
 
             // acknowledge killing of mission mob...
-            if (task["m_iCSUNumToKill"][j] != 0) {
+            if (task.killCounts[j] != 0) {
                 missionmob = true;
                 if (plr->RemainingNPCCount[i][j] > 0) {
                     plr->RemainingNPCCount[i][j]--;
                 }
             }
             // drop quest item
-            if (task["m_iCSUItemNumNeeded"][j] != 0 && !isQuestItemFull(sock, task["m_iCSUItemID"][j], task["m_iCSUItemNumNeeded"][j]) ) {
-                bool drop = rolledQItem % 100 < task["m_iSTItemDropRate"][j];
+            if (task.dropItemCounts[j] != 0 && !isQuestItemFull(sock, task.dropItemIDs[j], task.dropItemCounts[j]) ) {
+                bool drop = rolledQItem % 100 < task.dropRates[j];
                 if (drop) {
                     // XXX: are CSUItemID and CSTItemID the same?
-                    dropQuestItem(sock, plr->tasks[i], 1, task["m_iCSUItemID"][j], mobid);
+                    dropQuestItem(sock, plr->tasks[i], 1, task.dropItemIDs[j], mobid);
                 } else {
                     // fail to drop (itemID == 0)
                     dropQuestItem(sock, plr->tasks[i], 1, 0, mobid);
@@ -595,8 +607,8 @@ void Missions::failInstancedMissions(CNSocket* sock) {
             continue; // sanity check
 
         TaskData* task = Missions::Tasks[taskNum];
-        if (task->task["m_iRequireInstanceID"] != 0) { // mission is instanced
-            int failTaskID = task->task["m_iFOutgoingTask"];
+        if (task->requiredInstance != 0) { // mission is instanced
+            int failTaskID = task->failTask;
             if (failTaskID != 0) {
                 Missions::quitTask(sock, taskNum, false);
                 //plr->tasks[i] = failTaskID; // this causes the client to freak out and send a dupe task
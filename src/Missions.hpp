@@ -5,6 +5,8 @@
 
 #include "JSON.hpp"
 
+#include <unordered_map>
+
 struct Reward {
     int32_t id;
     int32_t itemTypes[4];
@@ -21,23 +23,44 @@ struct Reward {
     };
 };
 
+/*
+ * The fields of a task (m_pMissionData) the server actually uses, copied out of the xdt at load time.
+ * Per-slot arrays are indexed the same way as in the xdt.
+ */
 struct TaskData {
-    /*
-     * TODO: We'll probably want to keep only the data the server actually needs,
-     *       but for now RE/development is much easier if we have everything at
-     *       our fingertips.
-     */
-    nlohmann::json task;
+    int32_t id; // m_iHTaskID
+    int32_t missionID; // m_iHMissionID
+    int32_t taskType; // m_iHTaskType
+    int32_t terminatorNPC; // m_iHTerminatorNPCID
+    int32_t waypointNPC; // m_iSTGrantWayPoint
+    int32_t timeLimit; // m_iSTGrantTimer, 0 if untimed
+    int32_t nanoID; // m_iSTNanoID, the nano a nano mission rewards
+    int32_t nextTask; // m_iSUOutgoingTask, 0 for the last task of a mission
+    int32_t failTask; // m_iFOutgoingTask
+    int32_t requiredInstance; // m_iRequireInstanceID
+    int32_t barkerTextIDs[4]; // m_iHBarkerTextID
+
+    // mobs to kill, and the quest items they drop
+    int32_t enemyIDs[3]; // m_iCSUEnemyID
+    int32_t killCounts[3]; // m_iCSUNumToKill
+    int32_t dropItemIDs[3]; // m_iCSUItemID
+    int32_t dropItemCounts[3]; // m_iCSUItemNumNeeded
+    int32_t dropRates[3]; // m_iSTItemDropRate, percent
 
-    TaskData(nlohmann::json t) : task(t) {}
+    // quest items handed out when the task starts
+    int32_t startItemIDs[3]; // m_iSTItemID
+    int32_t startItemCounts[3]; // m_iSTItemNumNeeded
 
-    // convenience
-    auto operator[](std::string s) { return task[s]; }
+    // quest items given when the task ends; negative counts take them away
+    int32_t endItemIDs[3]; // m_iSUItem
+    int32_t endItemCounts[3]; // m_iSUInstancename
 };
 
 namespace Missions {
     extern std::map<int32_t, Reward*> Rewards;
     extern std::map<int32_t, TaskData*> Tasks;
+    // enemy NPC type -> IDs of the tasks that need it killed, so kills can skip everything else
+    extern std::unordered_map<int32_t, std::vector<int32_t>> EnemyTasks;
     extern nlohmann::json AvatarGrowth[37];
     void init();
 
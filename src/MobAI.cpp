@@ -8,15 +8,63 @@
 
 #include <cmath>
 #include <limits.h>
+#include <atomic>
+
+#if defined(__MINGW32__) && !defined(_GLIBCXX_HAS_GTHREADS)
+    #include "mingw/mingw.mutex.h"
+    #include "mingw/mingw.thread.h"
+#else
+    #include <mutex>
+    #include <thread>
+#endif
 
 using namespace MobAI;
 
 std::map<int32_t, Mob*> MobAI::Mobs;
+
+// summons and lair copies are allocated and freed all the time
+static SlabPool mobPool("Mob", sizeof(Mob));
+
+void* Mob::operator new(size_t size) {
+    return mobPool.alloc(size);
+}
+
+void Mob::operator delete(void* p, size_t size) {
+    mobPool.free(p, size);
+}
+std::vector<MobTemplate> MobAI::MobTemplates;
 static std::queue<int32_t> RemovalQueue;
 
 bool MobAI::simulateMobs;
 
-static void roamingStep(Mob *mob, time_t currTime);
+/*
+ * Each tick is split in two. The think phase runs across several threads and only
+ * reads world state, filling in one of these per mob; the commit phase then runs the
+ * usual state machine serially, in Mobs order, using the results instead of redoing
+ * the work. Since think never writes anything, the outcome doesn't depend on how many
+ * threads there are.
+ */
+struct MobIntent {
+    Mob *mob;
+    bool scanned; // whether target holds the result of an aggro scan
+    CNSocket *target;
+};
+
+static std::vector<MobIntent> intents;
+
+/*
+ * Only mobs someone can see are stepped every tick. Mobs that are dead or retreating
+ * still need to be stepped when nobody's around, but only at the times they'd
+ * actually do something, so they wait in wakeups until then.
+ */
+static std::vector<Mob*> activeMobs;
+static std::priority_queue<std::pair<time_t, int32_t>, std::vector<std::pair<time_t, int32_t>>,
+    std::greater<std::pair<time_t, int32_t>>> wakeups;
+static uint64_t tickCount = 0;
+static int thinkThreads = 1;
+static const size_t THINK_BATCH = 256; // mobs per work item
+
+static void roamingStep(Mob *mob, time_t currTime, MobIntent *intent=nullptr);
 
 /*
  * Dynamic lerp; distinct from Transport::lerp(). This one doesn't care about height and
@@ -60,6 +108,10 @@ void MobAI::clearDebuff(Mob *mob) {
 }
 
 void MobAI::followToCombat(Mob *mob) {
+    CNSocket *sock = PlayerManager::getSockFromHandle(mob->target);
+    if (sock == nullptr)
+        return;
+
     if (Mobs.find(mob->groupLeader) != Mobs.end()) {
         Mob* leadMob = Mobs[mob->groupLeader];
         for (int i = 0; i < 4; i++) {
@@ -75,16 +127,67 @@ void MobAI::followToCombat(Mob *mob) {
             if (followerMob->state != MobState::ROAMING) // only roaming mobs should transition to combat
                 continue;
 
-            enterCombat(mob->target, followerMob);
+            enterCombat(sock, followerMob);
         }
 
         if (leadMob->state != MobState::ROAMING)
             return;
 
-        enterCombat(mob->target, leadMob);
+        enterCombat(sock, leadMob);
+    }
+}
+
+void MobAI::updateActive(BaseNPC *npc) {
+    if (npc->npcClass != NPC_MOB)
+        return;
+
+    Mob *mob = (Mob*)npc;
+    bool visible = mob->playersInView > 0;
+
+    if (visible && mob->activeIndex == -1) {
+        mob->activeIndex = activeMobs.size();
+        activeMobs.push_back(mob);
+    } else if (!visible && mob->activeIndex != -1) {
+        deactivate(mob);
+
+        // finish dying or retreating without anyone watching
+        if (mob->state == MobState::DEAD || mob->state == MobState::RETREAT)
+            wake(mob);
     }
 }
 
+// step the mob on the next tick, even if nobody can see it
+void MobAI::wake(Mob *mob) {
+    wakeups.push({0, mob->appearanceData.iNPC_ID});
+}
+
+void MobAI::deactivate(Mob *mob) {
+    if (mob->activeIndex == -1)
+        return;
+
+    // swap-remove
+    Mob *last = activeMobs.back();
+    activeMobs[mob->activeIndex] = last;
+    last->activeIndex = mob->activeIndex;
+    activeMobs.pop_back();
+
+    mob->activeIndex = -1;
+}
+
+// when an unseen dead or retreating mob next has something to do
+static time_t nextWakeup(Mob *mob) {
+    if (mob->state == MobState::RETREAT)
+        return mob->nextMovement;
+
+    time_t wakeTime = mob->killedTime + mob->regenTime * 100; // respawn
+    if (mob->killedTime != 0 && !mob->despawned)
+        wakeTime = std::min(wakeTime, mob->killedTime + 2000); // despawn
+    if (mob->groupLeader == mob->appearanceData.iNPC_ID)
+        wakeTime = std::min(wakeTime, mob->nextMovement); // dead leaders keep guiding their group
+
+    return wakeTime;
+}
+
 void MobAI::groupRetreat(Mob *mob) {
     if (Mobs.find(mob->groupLeader) == Mobs.end())
         return;
@@ -100,22 +203,26 @@ void MobAI::groupRetreat(Mob *mob) {
         }
         Mob* followerMob = Mobs[leadMob->groupMember[i]];
 
-        followerMob->target = nullptr;
+        followerMob->target = {};
         followerMob->state = MobState::RETREAT;
         clearDebuff(followerMob);
+        wake(followerMob);
     }
 
-    leadMob->target = nullptr;
+    leadMob->target = {};
     leadMob->state = MobState::RETREAT;
     clearDebuff(leadMob);
+    wake(leadMob);
 }
 
 /*
- * Aggro on nearby players.
+ * Find the closest player the mob would aggro on, if any.
  * Even if they're in range, we can't assume they're all in the same one chunk
  * as the mob, since it might be near a chunk boundary.
+ *
+ * Only reads world state, so the think phase can call this from any thread.
  */
-bool MobAI::aggroCheck(Mob *mob, time_t currTime) {
+static CNSocket *findAggroTarget(Mob *mob) {
     CNSocket *closest = nullptr;
     int closestDistance = INT_MAX;
 
@@ -157,6 +264,11 @@ bool MobAI::aggroCheck(Mob *mob, time_t currTime) {
         }
     }
 
+    return closest;
+}
+
+// engage the player found by findAggroTarget(), if there is one
+static bool engage(Mob *mob, CNSocket *closest) {
     if (closest != nullptr) {
         // found closest player. engage.
         enterCombat(closest, mob);
@@ -170,8 +282,15 @@ bool MobAI::aggroCheck(Mob *mob, time_t currTime) {
     return false;
 }
 
+/*
+ * Aggro on nearby players.
+ */
+bool MobAI::aggroCheck(Mob *mob, time_t currTime) {
+    return engage(mob, findAggroTarget(mob));
+}
+
 static void dealCorruption(Mob *mob, std::vector<int> targetData, int skillID, int style) {
-    Player *plr = PlayerManager::getPlayer(mob->target);
+    Player *plr = PlayerManager::getPlayer(PlayerManager::getSockFromHandle(mob->target));
 
     size_t resplen = sizeof(sP_FE2CL_NPC_SKILL_CORRUPTION_HIT) + targetData[0] * sizeof(sCAttackResult);
 
@@ -226,7 +345,7 @@ static void dealCorruption(Mob *mob, std::vector<int> targetData, int skillID, i
         int style2 = Nanos::nanoStyle(plr->activeNano);
         if (style2 == -1) { // no nano
             respdata[i].iHitFlag = 8;
-            respdata[i].iDamage = Nanos::SkillTable[skillID].powerIntensity[0] * PC_MAXHEALTH((int)mob->data["m_iNpcLevel"]) / 1500;
+            respdata[i].iDamage = Nanos::SkillTable[skillID].powerIntensity[0] * PC_MAXHEALTH(mob->data->level) / 1500;
         } else if (style == style2) {
             respdata[i].iHitFlag = 8; // tie
             respdata[i].iDamage = 0;
@@ -244,7 +363,7 @@ static void dealCorruption(Mob *mob, std::vector<int> targetData, int skillID, i
                     pwr.handle(sock, targetData2, plr->activeNano, skillID, 0, 200);
         } else {
             respdata[i].iHitFlag = 16; // lose
-            respdata[i].iDamage = Nanos::SkillTable[skillID].powerIntensity[0] * PC_MAXHEALTH((int)mob->data["m_iNpcLevel"]) / 1500;
+            respdata[i].iDamage = Nanos::SkillTable[skillID].powerIntensity[0] * PC_MAXHEALTH(mob->data->level) / 1500;
             respdata[i].iNanoStamina = plr->Nanos[plr->activeNano].iStamina -= 90;
             if (plr->Nanos[plr->activeNano].iStamina < 0) {
                 respdata[i].bNanoDeactive = 1;
@@ -259,7 +378,7 @@ static void dealCorruption(Mob *mob, std::vector<int> targetData, int skillID, i
         respdata[i].iConditionBitFlag = plr->iConditionBitFlag;
 
         if (plr->HP <= 0) {
-            mob->target = nullptr;
+            mob->target = {};
             mob->state = MobState::RETREAT;
             if (!aggroCheck(mob, getTime())) {
                 clearDebuff(mob);
@@ -279,10 +398,10 @@ static void useAbilities(Mob *mob, time_t currTime) {
      * second to fifth integers are IDs, these can be either player iID or mob's iID
      * whether the skill targets players or mobs is determined by the skill packet being fired
      */
-    Player *plr = PlayerManager::getPlayer(mob->target);
+    Player *plr = PlayerManager::getPlayer(PlayerManager::getSockFromHandle(mob->target));
 
     if (mob->skillStyle >= 0) { // corruption hit
-        int skillID = (int)mob->data["m_iCorruptionType"];
+        int skillID = mob->data->corruptionType;
         std::vector<int> targetData = {1, plr->iID, 0, 0, 0};
         int temp = mob->skillStyle;
         mob->skillStyle = -3; // corruption cooldown
@@ -292,7 +411,7 @@ static void useAbilities(Mob *mob, time_t currTime) {
     }
 
     if (mob->skillStyle == -2) { // eruption hit
-        int skillID = (int)mob->data["m_iMegaType"];
+        int skillID = mob->data->megaType;
         std::vector<int> targetData = {0, 0, 0, 0, 0};
 
         // find the players within range of eruption
@@ -328,12 +447,12 @@ static void useAbilities(Mob *mob, time_t currTime) {
     }
 
     int random = rand() % 2000 * 1000;
-    int prob1 = (int)mob->data["m_iActiveSkill1Prob"]; // active skill probability
-    int prob2 = (int)mob->data["m_iCorruptionTypeProb"]; // corruption probability
-    int prob3 = (int)mob->data["m_iMegaTypeProb"]; // eruption probability
+    int prob1 = mob->data->activeSkill1Prob; // active skill probability
+    int prob2 = mob->data->corruptionTypeProb; // corruption probability
+    int prob3 = mob->data->megaTypeProb; // eruption probability
 
     if (random < prob1) { // active skill hit
-        int skillID = (int)mob->data["m_iActiveSkill1"];
+        int skillID = mob->data->activeSkill1;
         std::vector<int> targetData = {1, plr->iID, 0, 0, 0};
         for (auto& pwr : Combat::MobPowers)
             if (pwr.skillType == Nanos::SkillTable[skillID].skillType) {
@@ -341,12 +460,12 @@ static void useAbilities(Mob *mob, time_t currTime) {
                     return; // prevent debuffing a player twice
                 pwr.handle(mob, targetData, skillID, Nanos::SkillTable[skillID].durationTime[0], Nanos::SkillTable[skillID].powerIntensity[0]);
             }
-        mob->nextAttack = currTime + (int)mob->data["m_iDelayTime"] * 100;
+        mob->nextAttack = currTime + mob->data->delayTime * 100;
         return;
     }
 
     if (random < prob1 + prob2) { // corruption windup
-        int skillID = (int)mob->data["m_iCorruptionType"];
+        int skillID = mob->data->corruptionType;
         INITSTRUCT(sP_FE2CL_NPC_SKILL_CORRUPTION_READY, pkt);
         pkt.iNPC_ID = mob->appearanceData.iNPC_ID;
         pkt.iSkillID = skillID;
@@ -365,7 +484,7 @@ static void useAbilities(Mob *mob, time_t currTime) {
     }
 
     if (random < prob1 + prob2 + prob3) { // eruption windup
-        int skillID = (int)mob->data["m_iMegaType"];
+        int skillID = mob->data->megaType;
         INITSTRUCT(sP_FE2CL_NPC_SKILL_READY, pkt);
         pkt.iNPC_ID = mob->appearanceData.iNPC_ID;
         pkt.iSkillID = skillID;
@@ -382,7 +501,7 @@ static void useAbilities(Mob *mob, time_t currTime) {
 }
 
 void MobAI::enterCombat(CNSocket *sock, Mob *mob) {
-    mob->target = sock;
+    mob->target = PlayerManager::getHandle(sock);
     mob->state = MobState::COMBAT;
     mob->nextMovement = getTime();
     mob->nextAttack = 0;
@@ -391,7 +510,7 @@ void MobAI::enterCombat(CNSocket *sock, Mob *mob) {
     mob->roamY = mob->appearanceData.iY;
     mob->roamZ = mob->appearanceData.iZ;
 
-    int skillID = (int)mob->data["m_iPassiveBuff"]; // cast passive
+    int skillID = mob->data->passiveBuff; // cast passive
     std::vector<int> targetData = {1, mob->appearanceData.iNPC_ID, 0, 0, 0};
     for (auto& pwr : Combat::MobPowers)
         if (pwr.skillType == Nanos::SkillTable[skillID].skillType)
@@ -424,7 +543,7 @@ static void drainMobHP(Mob *mob, int amount) {
     NPCManager::sendToViewable(mob, (void*)&respbuf, P_FE2CL_CHAR_TIME_BUFF_TIME_TICK, resplen);
 
     if (mob->appearanceData.iHP <= 0)
-        Combat::killMob(mob->target, mob);
+        Combat::killMob(PlayerManager::getSockFromHandle(mob->target), mob);
 }
 
 static void deadStep(Mob *mob, time_t currTime) {
@@ -484,11 +603,12 @@ static void deadStep(Mob *mob, time_t currTime) {
 }
 
 static void combatStep(Mob *mob, time_t currTime) {
-    assert(mob->target != nullptr);
+    assert(!mob->target.isNull());
 
     // lose aggro if the player lost connection
-    if (PlayerManager::players.find(mob->target) == PlayerManager::players.end()) {
-        mob->target = nullptr;
+    CNSocket *sock = PlayerManager::getSockFromHandle(mob->target);
+    if (sock == nullptr) {
+        mob->target = {};
         mob->state = MobState::RETREAT;
         if (!aggroCheck(mob, currTime)) {
             clearDebuff(mob);
@@ -498,12 +618,12 @@ static void combatStep(Mob *mob, time_t currTime) {
         return;
     }
 
-    Player *plr = PlayerManager::getPlayer(mob->target);
+    Player *plr = PlayerManager::getPlayer(sock);
 
     // lose aggro if the player became invulnerable or died
     if (plr->HP <= 0
      || (plr->iSpecialState & CN_SPECIAL_STATE_FLAG__INVULNERABLE)) {
-        mob->target = nullptr;
+        mob->target = {};
         mob->state = MobState::RETREAT;
         if (!aggroCheck(mob, currTime)) {
             clearDebuff(mob);
@@ -550,17 +670,17 @@ static void combatStep(Mob *mob, time_t currTime) {
     }
 
     int distance = hypot(plr->x - mob->appearanceData.iX, plr->y - mob->appearanceData.iY);
-    int mobRange = (int)mob->data["m_iAtkRange"] + (int)mob->data["m_iRadius"];
+    int mobRange = mob->data->atkRange + mob->data->radius;
 
     if (currTime >= mob->nextAttack) {
         if (mob->skillStyle != -1 || distance <= mobRange || rand() % 20 == 0) // while not in attack range, 1 / 20 chance.
             useAbilities(mob, currTime);
-        if (mob->target == nullptr)
+        if (mob->target.isNull())
             return;
     }
 
     int distanceToTravel = INT_MAX;
-    int speed = mob->data["m_iRunSpeed"];
+    int speed = mob->data->runSpeed;
     // movement logic: move when out of range but don't move while casting a skill
     if (distance > mobRange && mob->skillStyle == -1) {
         if (mob->nextMovement != 0 && currTime < mob->nextMovement)
@@ -606,7 +726,7 @@ static void combatStep(Mob *mob, time_t currTime) {
      */
     if (distance <= mobRange || distanceToTravel < speed*2/5) {
         if (mob->nextAttack == 0 || currTime >= mob->nextAttack) {
-            mob->nextAttack = currTime + (int)mob->data["m_iDelayTime"] * 100;
+            mob->nextAttack = currTime + mob->data->delayTime * 100;
             Combat::npcAttackPc(mob, currTime);
         }
     }
@@ -614,8 +734,8 @@ static void combatStep(Mob *mob, time_t currTime) {
     // retreat if the player leaves combat range
     int xyDistance = hypot(plr->x - mob->roamX, plr->y - mob->roamY);
     distance = hypot(xyDistance, plr->z - mob->roamZ);
-    if (distance >= mob->data["m_iCombatRange"]) {
-        mob->target = nullptr;
+    if (distance >= mob->data->combatRange) {
+        mob->target = {};
         mob->state = MobState::RETREAT;
         clearDebuff(mob);
         if (mob->groupLeader != 0)
@@ -627,11 +747,11 @@ void MobAI::incNextMovement(Mob *mob, time_t currTime) {
     if (currTime == 0)
         currTime = getTime();
 
-    int delay = (int)mob->data["m_iDelayTime"] * 1000;
+    int delay = mob->data->delayTime * 1000;
     mob->nextMovement = currTime + delay/2 + rand() % (delay/2);
 }
 
-static void roamingStep(Mob *mob, time_t currTime) {
+static void roamingStep(Mob *mob, time_t currTime, MobIntent *intent) {
     /*
      * We reuse nextAttack to avoid scanning for players all the time, but to still
      * do so more often than if we waited for nextMovement (which is way too slow).
@@ -639,7 +759,19 @@ static void roamingStep(Mob *mob, time_t currTime) {
      */
     if (mob->state != MobState::DEAD && (mob->nextAttack == 0 || currTime >= mob->nextAttack)) {
         mob->nextAttack = currTime + 500;
-        if (aggroCheck(mob, currTime))
+
+        CNSocket *target;
+        if (intent != nullptr && intent->scanned) {
+            target = intent->target;
+
+            // another mob may have killed them earlier in this tick
+            if (target != nullptr && PlayerManager::getPlayer(target)->HP <= 0)
+                target = findAggroTarget(mob);
+        } else {
+            target = findAggroTarget(mob);
+        }
+
+        if (engage(mob, target))
             return;
     }
 
@@ -661,7 +793,7 @@ static void roamingStep(Mob *mob, time_t currTime) {
 
     int xStart = mob->spawnX - mob->idleRange/2;
     int yStart = mob->spawnY - mob->idleRange/2;
-    int speed = mob->data["m_iWalkSpeed"];
+    int speed = mob->data->walkSpeed;
 
     // some mobs don't move (and we mustn't divide/modulus by zero)
     if (mob->idleRange == 0 || speed == 0)
@@ -728,14 +860,14 @@ static void retreatStep(Mob *mob, time_t currTime) {
     // distance between spawn point and current location
     int distance = hypot(mob->appearanceData.iX - mob->roamX, mob->appearanceData.iY - mob->roamY);
 
-    //if (distance > mob->data["m_iIdleRange"]) {
+    //if (distance > mob->data->idleRange) {
     if (distance > 10) {
         INITSTRUCT(sP_FE2CL_NPC_MOVE, pkt);
 
-        auto targ = lerp(mob->appearanceData.iX, mob->appearanceData.iY, mob->roamX, mob->roamY, (int)mob->data["m_iRunSpeed"]*4/5);
+        auto targ = lerp(mob->appearanceData.iX, mob->appearanceData.iY, mob->roamX, mob->roamY, mob->data->runSpeed*4/5);
 
         pkt.iNPC_ID = mob->appearanceData.iNPC_ID;
-        pkt.iSpeed = (int)mob->data["m_iRunSpeed"] * 2;
+        pkt.iSpeed = mob->data->runSpeed * 2;
         pkt.iToX = mob->appearanceData.iX = targ.first;
         pkt.iToY = mob->appearanceData.iY = targ.second;
         pkt.iToZ = mob->appearanceData.iZ = mob->spawnZ;
@@ -746,7 +878,7 @@ static void retreatStep(Mob *mob, time_t currTime) {
     }
 
     // if we got there
-    //if (distance <= mob->data["m_iIdleRange"]) {
+    //if (distance <= mob->data->idleRange) {
     if (distance <= 10) { // retreat back to the spawn point
         mob->state = MobState::ROAMING;
         mob->appearanceData.iHP = mob->maxHealth;
@@ -764,33 +896,161 @@ static void retreatStep(Mob *mob, time_t currTime) {
     }
 }
 
+// skip mob movement and combat if disabled or not in view
+static bool isAsleep(Mob *mob) {
+    return (!simulateMobs || mob->playersInView == 0) && mob->state != MobState::DEAD
+        && mob->state != MobState::RETREAT;
+}
+
+static void think(MobIntent& intent, time_t currTime) {
+    Mob *mob = intent.mob;
+
+    if (isAsleep(mob))
+        return;
+
+    // same condition roamingStep() uses to decide whether to scan
+    if (mob->state == MobState::ROAMING && (mob->nextAttack == 0 || currTime >= mob->nextAttack)) {
+        intent.target = findAggroTarget(mob);
+        intent.scanned = true;
+    }
+}
+
+/*
+ * The think workers live for as long as the shard does. Idle ones wait on one of two gates that
+ * the shard thread keeps locked, so they cost nothing between ticks. A tick opens the gate for its
+ * generation and pitches in itself; once the batches run out it closes that gate again and waits for
+ * whoever got through. A worker that's done moves on to the other gate, which stays shut until the
+ * next tick, so it never comes back around to the one the shard is trying to close. Workers count
+ * themselves in while still holding the gate, so nobody can slip through after the shard has
+ * stopped waiting.
+ */
+static std::mutex thinkGates[2];
+static std::vector<std::thread*> thinkPool;
+static std::atomic<uint64_t> thinkGen(0);
+static std::atomic<size_t> thinkNext(0);
+static std::atomic<int> thinkBusy(0);
+static std::atomic<bool> thinkStopping(false);
+static time_t thinkTime;
+
+static void thinkBatches() {
+    while (true) {
+        size_t start = thinkNext.fetch_add(THINK_BATCH);
+        if (start >= intents.size())
+            return;
+
+        size_t end = std::min(start + THINK_BATCH, intents.size());
+        for (size_t i = start; i < end; i++)
+            think(intents[i], thinkTime);
+    }
+}
+
+static void thinkWorker() {
+    uint64_t gen = 0;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(thinkGates[(gen + 1) % 2]);
+            thinkBusy++;
+        }
+
+        gen = thinkGen;
+        if (thinkStopping) {
+            thinkBusy--;
+            return;
+        }
+
+        thinkBatches();
+        thinkBusy--;
+    }
+}
+
+static void thinkAll(time_t currTime) {
+    thinkTime = currTime;
+    thinkNext = 0;
+
+    // not worth waking up other threads for a single batch
+    if (thinkThreads <= 1 || intents.size() <= THINK_BATCH) {
+        thinkBatches();
+        return;
+    }
+
+    // started on first use, so the gates are owned by the thread that runs ticks
+    if (thinkPool.empty()) {
+        thinkGates[0].lock();
+        thinkGates[1].lock();
+        for (int i = 1; i < thinkThreads; i++)
+            thinkPool.push_back(new std::thread(thinkWorker));
+    }
+
+    std::mutex& gate = thinkGates[++thinkGen % 2];
+    gate.unlock();
+    thinkBatches();
+    gate.lock();
+
+    while (thinkBusy > 0)
+        std::this_thread::yield();
+}
+
+// adds the mob to this tick's work, once
+static void schedule(Mob *mob) {
+    if (mob->scheduledTick == tickCount)
+        return;
+
+    mob->scheduledTick = tickCount;
+    intents.push_back({mob, false, nullptr});
+}
+
 static void step(CNServer *serv, time_t currTime) {
-    for (auto& pair : Mobs) {
-        if (pair.second->playersInView < 0)
-            std::cout << "[WARN] Weird playerview value " << pair.second->playersInView << std::endl;
+    tickCount++;
+    intents.clear();
+
+    for (Mob *mob : activeMobs)
+        schedule(mob);
+
+    while (!wakeups.empty() && wakeups.top().first <= currTime) {
+        auto it = Mobs.find(wakeups.top().second);
+        if (it != Mobs.end()) // might've been removed since
+            schedule(it->second);
+        wakeups.pop();
+    }
 
-        // skip mob movement and combat if disabled or not in view
-        if ((!simulateMobs || pair.second->playersInView == 0) && pair.second->state != MobState::DEAD
-        && pair.second->state != MobState::RETREAT)
+    // same order as Mobs, so results don't depend on when mobs came into view
+    std::sort(intents.begin(), intents.end(), [](const MobIntent& a, const MobIntent& b) {
+        return a.mob->appearanceData.iNPC_ID < b.mob->appearanceData.iNPC_ID;
+    });
+
+    thinkAll(currTime);
+
+    // commit; earlier mobs can change the state of later ones (groups), so re-check everything here
+    for (MobIntent& intent : intents) {
+        Mob *mob = intent.mob;
+
+        if (mob->playersInView < 0)
+            std::cout << "[WARN] Weird playerview value " << mob->playersInView << std::endl;
+
+        if (isAsleep(mob))
             continue;
 
-        switch (pair.second->state) {
+        switch (mob->state) {
         case MobState::INACTIVE:
             // no-op
             break;
         case MobState::ROAMING:
-            roamingStep(pair.second, currTime);
+            roamingStep(mob, currTime, &intent);
             break;
         case MobState::COMBAT:
-            combatStep(pair.second, currTime);
+            combatStep(mob, currTime);
             break;
         case MobState::RETREAT:
-            retreatStep(pair.second, currTime);
+            retreatStep(mob, currTime);
             break;
         case MobState::DEAD:
-            deadStep(pair.second, currTime);
+            deadStep(mob, currTime);
             break;
         }
+
+        // if nobody can see it, come back when there's more to do
+        if (mob->activeIndex == -1 && (mob->state == MobState::DEAD || mob->state == MobState::RETREAT))
+            wakeups.push({nextWakeup(mob), mob->appearanceData.iNPC_ID});
     }
 
     // deallocate all NPCs queued for removal
@@ -804,4 +1064,24 @@ void MobAI::init() {
     REGISTER_SHARD_TIMER(step, 200);
 
     simulateMobs = settings::SIMULATEMOBS;
+
+    thinkThreads = settings::MOBAITHREADS;
+    if (thinkThreads <= 0)
+        thinkThreads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+void MobAI::shutdown() {
+    if (thinkPool.empty())
+        return;
+
+    // stragglers that missed the last tick are still waiting on its gate, so open both
+    thinkStopping = true;
+    thinkGates[0].unlock();
+    thinkGates[1].unlock();
+
+    for (std::thread* worker : thinkPool) {
+        worker->join();
+        delete worker;
+    }
+    thinkPool.clear();
 }
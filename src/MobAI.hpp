@@ -11,6 +11,36 @@ enum class MobState {
     DEAD
 };
 
+// the parts of an NPC table entry that mobs use; one per NPC type, shared by every mob of that type
+struct MobTemplate {
+    int maxHealth; // m_iHP
+    int sightRange;
+    int regenTime;
+    int idleRange;
+    int dropType;
+    int level; // m_iNpcLevel
+
+    // combat
+    int power;
+    int protection;
+    int style; // m_iNpcStyle
+    int atkRange;
+    int radius;
+    int combatRange;
+    int delayTime;
+    int walkSpeed;
+    int runSpeed;
+
+    // abilities
+    int activeSkill1;
+    int activeSkill1Prob;
+    int corruptionType;
+    int corruptionTypeProb;
+    int megaType;
+    int megaTypeProb;
+    int passiveBuff;
+};
+
 struct Mob : public BaseNPC {
     // general
     MobState state;
@@ -36,7 +66,7 @@ struct Mob : public BaseNPC {
     int roamX, roamY, roamZ;
 
     // combat
-    CNSocket *target = nullptr;
+    EntityHandle target; // in PlayerManager::Handles; empty while not in combat
     time_t nextAttack = 0;
     time_t lastDrainTime = 0;
     int skillStyle = -1; // -1 for nothing, 0-2 for corruption, -2 for eruption
@@ -50,21 +80,24 @@ struct Mob : public BaseNPC {
     int offsetX, offsetY;
     int groupMember[4] = {0, 0, 0, 0};
 
-    // temporary; until we're sure what's what
-    nlohmann::json data;
+    // scheduling
+    int activeIndex = -1; // position in the active mob list, -1 if nobody can see it
+    uint64_t scheduledTick = 0;
+
+    // shared with every other mob of this type; points into MobAI::MobTemplates
+    const MobTemplate* data;
 
-    Mob(int x, int y, int z, int angle, uint64_t iID, int type, nlohmann::json d, int32_t id)
+    Mob(int x, int y, int z, int angle, uint64_t iID, int type, const MobTemplate* d, int32_t id)
         : BaseNPC(x, y, z, angle, iID, type, id),
-          maxHealth(d["m_iHP"]),
-          sightRange(d["m_iSightRange"]) {
+          maxHealth(d->maxHealth),
+          sightRange(d->sightRange),
+          data(d) {
         state = MobState::ROAMING;
 
-        data = d;
-
-        regenTime = data["m_iRegenTime"];
-        idleRange = (int)data["m_iIdleRange"];
-        dropType = data["m_iDropType"];
-        level = data["m_iNpcLevel"];
+        regenTime = data->regenTime;
+        idleRange = data->idleRange;
+        dropType = data->dropType;
+        level = data->level;
 
         roamX = spawnX = appearanceData.iX;
         roamY = spawnY = appearanceData.iY;
@@ -82,23 +115,25 @@ struct Mob : public BaseNPC {
     }
 
     // constructor for /summon
-    Mob(int x, int y, int z, uint64_t iID, int type, nlohmann::json d, int32_t id)
+    Mob(int x, int y, int z, uint64_t iID, int type, const MobTemplate* d, int32_t id)
         : Mob(x, y, z, 0, iID, type, d, id) {
         summoned = true; // will be despawned and deallocated when killed
     }
 
     ~Mob() {}
 
-    auto operator[](std::string s) {
-        return data[s];
-    }
+    static void* operator new(size_t size);
+    static void operator delete(void* p, size_t size);
 };
 
 namespace MobAI {
     extern bool simulateMobs;
     extern std::map<int32_t, Mob*> Mobs;
+    extern std::vector<MobTemplate> MobTemplates; // indexed by NPC type, like NPCManager::NPCData
 
     void init();
+    // stops the think workers; has to be called from the thread that runs the shard
+    void shutdown();
 
     // TODO: make this internal later
     void incNextMovement(Mob *mob, time_t currTime=0);
@@ -107,4 +142,8 @@ namespace MobAI {
     void followToCombat(Mob *mob);
     void groupRetreat(Mob *mob);
     void enterCombat(CNSocket *sock, Mob *mob);
+
+    void updateActive(BaseNPC *npc);
+    void wake(Mob *mob);
+    void deactivate(Mob *mob);
 }
@@ -13,6 +13,7 @@ public:
     int playersInView;
 
     BaseNPC() {};
+    virtual ~BaseNPC() {}; // so delete through a BaseNPC* frees a Mob or an Egg properly
     BaseNPC(int x, int y, int z, int angle, uint64_t iID, int type, int id) {
         appearanceData.iX = x;
         appearanceData.iY = y;
@@ -29,10 +30,14 @@ public:
         instanceID = iID;
 
         chunkPos = std::make_tuple(0, 0, 0);
-        viewableChunks = new std::set<Chunk*>();
+        viewableChunks = Chunking::ViewableSets.make();
         playersInView = 0;
     };
     BaseNPC(int x, int y, int z, int angle, uint64_t iID, int type, int id, NPCClass classType) : BaseNPC(x, y, z, angle, iID, type, id) {
         npcClass = classType;
     }
+
+    // pooled; subclasses bring their own pools
+    static void* operator new(size_t size);
+    static void operator delete(void* p, size_t size);
 };
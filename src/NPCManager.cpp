@@ -36,6 +36,16 @@ nlohmann::json NPCManager::NPCData;
  */
 int32_t NPCManager::nextId;
 
+static SlabPool npcPool("BaseNPC", sizeof(BaseNPC));
+
+void* BaseNPC::operator new(size_t size) {
+    return npcPool.alloc(size);
+}
+
+void BaseNPC::operator delete(void* p, size_t size) {
+    npcPool.free(p, size);
+}
+
 void NPCManager::destroyNPC(int32_t id) {
     // sanity check
     if (NPCs.find(id) == NPCs.end()) {
@@ -58,15 +68,17 @@ void NPCManager::destroyNPC(int32_t id) {
     Chunking::removeNPCFromChunks(Chunking::getViewableChunks(entity->chunkPos), id);
 
     // remove from mob manager
-    if (MobAI::Mobs.find(id) != MobAI::Mobs.end())
+    if (MobAI::Mobs.find(id) != MobAI::Mobs.end()) {
+        MobAI::deactivate(MobAI::Mobs[id]);
         MobAI::Mobs.erase(id);
+    }
 
     // remove from eggs
     if (Eggs::Eggs.find(id) != Eggs::Eggs.end())
         Eggs::Eggs.erase(id);
 
     // finally, remove it from the map and free it
-    delete entity->viewableChunks;
+    Chunking::ViewableSets.destroy(entity->viewableChunks);
     NPCs.erase(id);
     delete entity;
 }
@@ -86,10 +98,11 @@ void NPCManager::updateNPCPosition(int32_t id, int X, int Y, int Z, uint64_t I,
 }
 
 void NPCManager::sendToViewable(BaseNPC *npc, void *buf, uint32_t type, size_t size) {
+    CNBroadcastPacket pkt(buf, type, size);
     for (auto it = npc->viewableChunks->begin(); it != npc->viewableChunks->end(); it++) {
         Chunk* chunk = *it;
         for (CNSocket *s : chunk->players) {
-            s->sendPacket(buf, type, size);
+            s->sendPacket(pkt);
         }
     }
 }
@@ -104,8 +117,8 @@ static void npcBarkHandler(CNSocket* sock, CNPacketData* data) {
     TaskData* td = Missions::Tasks[req->iMissionTaskID];
     std::vector<int> barks;
     for (int i = 0; i < 4; i++) {
-        if (td->task["m_iHBarkerTextID"][i] != 0) // non-zeroes only
-            barks.push_back(td->task["m_iHBarkerTextID"][i]);
+        if (td->barkerTextIDs[i] != 0) // non-zeroes only
+            barks.push_back(td->barkerTextIDs[i]);
     }
 
     if (barks.empty())
@@ -141,7 +154,7 @@ BaseNPC *NPCManager::summonNPC(int x, int y, int z, uint64_t instance, int type,
     BaseNPC *npc = nullptr;
 
     if (team == 2) {
-        npc = new Mob(x, y, z + EXTRA_HEIGHT, inst, type, NPCData[type], id);
+        npc = new Mob(x, y, z + EXTRA_HEIGHT, inst, type, &MobAI::MobTemplates[type], id);
         MobAI::Mobs[id] = (Mob*)npc;
 
         // re-enable respawning, if desired
@@ -4,6 +4,7 @@
 #include <cstring>
 
 #include "core/Core.hpp"
+#include "core/HandleTable.hpp"
 #include "Chunking.hpp"
 
 #define ACTIVE_MISSION_COUNT 6
@@ -87,8 +88,14 @@ struct Player {
     ChunkPos chunkPos;
     std::set<Chunk*> *viewableChunks;
     time_t lastHeartbeat;
+    uint64_t keepAliveTimer; // id on CNShardServer::Wheel
+    EntityHandle handle; // in PlayerManager::Handles
 
     int suspicionRating;
     time_t lastShot;
     std::vector<sItemBase> *buyback;
+
+    // pooled; see PlayerManager.cpp
+    static void* operator new(size_t size);
+    static void operator delete(void* p, size_t size);
 };
@@ -1,6 +1,7 @@
 #include "core/Core.hpp"
 #include "core/CNShared.hpp"
 #include "servers/CNShardServer.hpp"
+#include "servers/Handoff.hpp"
 #include "db/Database.hpp"
 #include "PlayerManager.hpp"
 #include "NPCManager.hpp"
@@ -26,7 +27,76 @@
 
 using namespace PlayerManager;
 
-std::map<CNSocket*, Player*> PlayerManager::players;
+std::unordered_map<CNSocket*, Player*> PlayerManager::players;
+HandleTable<CNSocket> PlayerManager::Handles;
+
+// also used for the DB writer's copies of what it last saved
+static SlabPool playerPool("Player", sizeof(Player));
+static ObjectPool<std::vector<sItemBase>> buybackPool("buyback");
+
+void* Player::operator new(size_t size) {
+    return playerPool.alloc(size);
+}
+
+void Player::operator delete(void* p, size_t size) {
+    playerPool.free(p, size);
+}
+
+/*
+ * Lookup indexes over players, kept in step with it by addPlayer() and removePlayer().
+ * Player IDs, account IDs and names don't change while someone is in game, so nothing else needs to touch these.
+ */
+static std::unordered_map<int32_t, CNSocket*> playersByID;
+static std::unordered_map<int, CNSocket*> playersByAccount;
+static std::unordered_map<std::string, CNSocket*> playersByName;
+
+// names can't contain newlines, so this can't confuse "A B" + "C" with "A" + "B C"
+static std::string nameKey(const std::string& firstname, const std::string& lastname) {
+    return firstname + '\n' + lastname;
+}
+
+static std::string nameKey(Player* plr) {
+    return nameKey(AUTOU16TOU8(plr->PCStyle.szFirstName), AUTOU16TOU8(plr->PCStyle.szLastName));
+}
+
+// only drops the entry if it's still this socket's; a newer session may have replaced it already
+template<typename K>
+static void unindex(std::unordered_map<K, CNSocket*>& index, const K& key, CNSocket* sock) {
+    auto it = index.find(key);
+    if (it != index.end() && it->second == sock)
+        index.erase(it);
+}
+
+static void indexPlayer(CNSocket* sock, Player* plr) {
+    playersByID[plr->iID] = sock;
+    playersByAccount[plr->accountId] = sock;
+    playersByName[nameKey(plr)] = sock;
+}
+
+static void unindexPlayer(CNSocket* sock, Player* plr) {
+    unindex(playersByID, plr->iID, sock);
+    unindex(playersByAccount, plr->accountId, sock);
+    unindex(playersByName, nameKey(plr), sock);
+}
+
+#ifndef NDEBUG
+static void checkIndexes() {
+    assert(playersByID.size() <= players.size());
+    assert(playersByAccount.size() <= players.size());
+    assert(playersByName.size() <= players.size());
+    assert(Handles.size() == players.size());
+
+    for (auto& pair : players)
+        assert(Handles.get(pair.second->handle) == pair.first);
+
+    for (auto& pair : playersByID)
+        assert(players.find(pair.second) != players.end() && players[pair.second]->iID == pair.first);
+    for (auto& pair : playersByAccount)
+        assert(players.find(pair.second) != players.end() && players[pair.second]->accountId == pair.first);
+    for (auto& pair : playersByName)
+        assert(players.find(pair.second) != players.end() && nameKey(players[pair.second]) == pair.first);
+}
+#endif
 
 static void addPlayer(CNSocket* key, Player plr) {
     Player *p = new Player();
@@ -34,10 +104,16 @@ static void addPlayer(CNSocket* key, Player plr) {
     memcpy(p, &plr, sizeof(Player));
 
     players[key] = p;
+    p->handle = Handles.add(key);
+    indexPlayer(key, p);
+#ifndef NDEBUG
+    checkIndexes();
+#endif
     p->chunkPos = std::make_tuple(0, 0, 0);
-    p->viewableChunks = new std::set<Chunk*>();
+    p->viewableChunks = Chunking::ViewableSets.make();
     p->lastHeartbeat = 0;
-    p->buyback = new std::vector<sItemBase>();
+    p->buyback = buybackPool.make();
+    CNShardServer::startKeepAlive(key);
 
     std::cout << getPlayerName(p) << " has joined!" << std::endl;
     std::cout << players.size() << " players" << std::endl;
@@ -55,8 +131,14 @@ void PlayerManager::removePlayer(CNSocket* key) {
     // remove player's ongoing race, if it exists
     Racing::EPRaces.erase(key);
 
+    CNShardServer::Wheel.cancel(plr->keepAliveTimer);
+
     // save player to DB
-    Database::updatePlayer(plr);
+    Database::updatePlayer(plr, true);
+    // a login server in another process can't see our save queue, so it waits to hear that it's on disk
+    // before letting them back in (and on to some other shard)
+    if (settings::SERVERMODE == "shard")
+        Handoff::playerLeft(plr);
 
     // remove player visually and untrack
     Chunking::removePlayerFromChunks(Chunking::getViewableChunks(plr->chunkPos), key);
@@ -64,10 +146,15 @@ void PlayerManager::removePlayer(CNSocket* key) {
 
     std::cout << getPlayerName(plr) << " has left!" << std::endl;
 
-    delete plr->buyback;
-    delete plr->viewableChunks;
+    unindexPlayer(key, plr);
+    Handles.remove(plr->handle);
+    buybackPool.destroy(plr->buyback);
+    Chunking::ViewableSets.destroy(plr->viewableChunks);
     delete plr;
     players.erase(key);
+#ifndef NDEBUG
+    checkIndexes();
+#endif
 
     // if the player was in a lair, clean it up
     Chunking::destroyInstanceIfEmpty(fromInstance);
@@ -199,7 +286,16 @@ static void enterPlayer(CNSocket* sock, CNPacketData* data) {
     sP_CL2FE_REQ_PC_ENTER* enter = (sP_CL2FE_REQ_PC_ENTER*)data->buf;
     INITSTRUCT(sP_FE2CL_REP_PC_ENTER_SUCC, response);
 
-    // TODO: check if serialkey exists, if it doesn't send sP_FE2CL_REP_PC_ENTER_FAIL
+    // with a separate login server, the client can get here before its handoff has been read
+    if (!CNSharedData::hasPlayer(enter->iEnterSerialKey))
+        Handoff::receivePending();
+
+    if (!CNSharedData::hasPlayer(enter->iEnterSerialKey)) {
+        INITSTRUCT(sP_FE2CL_REP_PC_ENTER_FAIL, fail);
+        sock->sendPacket((void*)&fail, P_FE2CL_REP_PC_ENTER_FAIL, sizeof(sP_FE2CL_REP_PC_ENTER_FAIL));
+        return;
+    }
+
     Player plr = CNSharedData::getPlayer(enter->iEnterSerialKey);
 
     plr.groupCnt = 1;
@@ -269,7 +365,7 @@ static void enterPlayer(CNSocket* sock, CNPacketData* data) {
         response.PCLoadData2CL.aRunningQuest[i].m_aCurrTaskID = plr.tasks[i];
         TaskData &task = *Missions::Tasks[plr.tasks[i]];
         for (int j = 0; j < 3; j++) {
-            response.PCLoadData2CL.aRunningQuest[i].m_aKillNPCID[j] = (int)task["m_iCSUEnemyID"][j];
+            response.PCLoadData2CL.aRunningQuest[i].m_aKillNPCID[j] = task.enemyIDs[j];
             response.PCLoadData2CL.aRunningQuest[i].m_aKillNPCCount[j] = plr.RemainingNPCCount[i][j];
             /*
              * client doesn't care about NeededItem ID and Count,
@@ -331,13 +427,14 @@ static void enterPlayer(CNSocket* sock, CNPacketData* data) {
 
 void PlayerManager::sendToViewable(CNSocket* sock, void* buf, uint32_t type, size_t size) {
     Player* plr = getPlayer(sock);
+    CNBroadcastPacket pkt(buf, type, size);
     for (auto it = plr->viewableChunks->begin(); it != plr->viewableChunks->end(); it++) {
         Chunk* chunk = *it;
         for (CNSocket* otherSock : chunk->players) {
             if (otherSock == sock)
                 continue;
 
-            otherSock->sendPacket(buf, type, size);
+            otherSock->sendPacket(pkt);
         }
     }
 }
@@ -600,6 +697,15 @@ Player *PlayerManager::getPlayer(CNSocket* key) {
     assert(false);
 }
 
+EntityHandle PlayerManager::getHandle(CNSocket* key) {
+    return getPlayer(key)->handle;
+}
+
+// nullptr if the player has since left, even if their socket's address got reused
+CNSocket *PlayerManager::getSockFromHandle(EntityHandle handle) {
+    return Handles.get(handle);
+}
+
 std::string PlayerManager::getPlayerName(Player *plr, bool id) {
     // the print in CNShardServer can print packets from players that haven't yet joined
     if (plr == nullptr)
@@ -618,57 +724,47 @@ std::string PlayerManager::getPlayerName(Player *plr, bool id) {
 }
 
 bool PlayerManager::isAccountInUse(int accountId) {
-    std::map<CNSocket*, Player*>::iterator it;
-    for (it = players.begin(); it != players.end(); it++) {
-        if (it->second->accountId == accountId)
-            return true;
-    }
-    return false;
+    return playersByAccount.find(accountId) != playersByAccount.end();
 }
 
 void PlayerManager::exitDuplicate(int accountId) {
-    std::map<CNSocket*, Player*>::iterator it;
+    auto it = playersByAccount.find(accountId);
+    if (it == playersByAccount.end())
+        return;
 
-    // disconnect any duplicate players
-    for (it = players.begin(); it != players.end(); it++) {
-        if (it->second->accountId == accountId) {
-            CNSocket* sock = it->first;
+    // disconnect the duplicate player
+    CNSocket* sock = it->second;
 
-            INITSTRUCT(sP_FE2CL_REP_PC_EXIT_DUPLICATE, resp);
-            resp.iErrorCode = 0;
-            sock->sendPacket((void*)&resp, P_FE2CL_REP_PC_EXIT_DUPLICATE, sizeof(sP_FE2CL_REP_PC_EXIT_DUPLICATE));
+    INITSTRUCT(sP_FE2CL_REP_PC_EXIT_DUPLICATE, resp);
+    resp.iErrorCode = 0;
+    sock->sendPacket((void*)&resp, P_FE2CL_REP_PC_EXIT_DUPLICATE, sizeof(sP_FE2CL_REP_PC_EXIT_DUPLICATE));
 
-            sock->kill();
-            CNShardServer::_killConnection(sock);
-            break;
-        }
-    }
+    sock->kill();
+    CNShardServer::_killConnection(sock);
 }
 
-// TODO: just call getPlayer() after getSockFromID()?
 Player *PlayerManager::getPlayerFromID(int32_t iID) {
-    for (auto& pair : players)
-        if (pair.second->iID == iID)
-            return pair.second;
+    auto it = playersByID.find(iID);
+    if (it == playersByID.end())
+        return nullptr;
 
-    return nullptr;
+    return players[it->second];
 }
 
 CNSocket *PlayerManager::getSockFromID(int32_t iID) {
-    for (auto& pair : players)
-        if (pair.second->iID == iID)
-            return pair.first;
+    auto it = playersByID.find(iID);
+    if (it == playersByID.end())
+        return nullptr;
 
-    return nullptr;
+    return it->second;
 }
 
 CNSocket *PlayerManager::getSockFromName(std::string firstname, std::string lastname) {
-    for (auto& pair : players)
-        if (AUTOU16TOU8(pair.second->PCStyle.szFirstName) == firstname
-        && AUTOU16TOU8(pair.second->PCStyle.szLastName) == lastname)
-            return pair.first;
+    auto it = playersByName.find(nameKey(firstname, lastname));
+    if (it == playersByName.end())
+        return nullptr;
 
-    return nullptr;
+    return it->second;
 }
 
 CNSocket *PlayerManager::getSockFromAny(int by, int id, int uid, std::string firstname, std::string lastname) {
@@ -676,11 +772,12 @@ CNSocket *PlayerManager::getSockFromAny(int by, int id, int uid, std::string fir
     case eCN_GM_TargetSearchBy__PC_ID:
         assert(id != 0);
         return getSockFromID(id);
-    case eCN_GM_TargetSearchBy__PC_UID: // account id; not player id
+    case eCN_GM_TargetSearchBy__PC_UID: { // account id; not player id
         assert(uid != 0);
-        for (auto& pair : players)
-            if (pair.second->accountId == uid)
-                return pair.first;
+        auto it = playersByAccount.find(uid);
+        if (it != playersByAccount.end())
+            return it->second;
+    }
     case eCN_GM_TargetSearchBy__PC_Name:
         assert(firstname != "" && lastname != ""); // XXX: remove this if we start messing around with edited names?
         return getSockFromName(firstname, lastname);
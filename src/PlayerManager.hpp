@@ -7,12 +7,15 @@
 
 #include <utility>
 #include <map>
+#include <unordered_map>
 #include <list>
 
 struct WarpLocation;
 
 namespace PlayerManager {
-    extern std::map<CNSocket*, Player*> players;
+    extern std::unordered_map<CNSocket*, Player*> players;
+    // for holding on to a player past the current packet or tick; see getSockFromHandle()
+    extern HandleTable<CNSocket> Handles;
     void init();
 
     void removePlayer(CNSocket* key);
@@ -25,6 +28,8 @@ namespace PlayerManager {
     void sendToViewable(CNSocket* sock, void* buf, uint32_t type, size_t size);
 
     Player *getPlayer(CNSocket* key);
+    EntityHandle getHandle(CNSocket* key);
+    CNSocket *getSockFromHandle(EntityHandle handle);
     std::string getPlayerName(Player *plr, bool id=true);
 
     bool isAccountInUse(int accountId);
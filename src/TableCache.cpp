@@ -0,0 +1,233 @@
+#include "TableCache.hpp"
+#include "settings.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * File layout, all integers little-endian:
+ *
+ *   "OFTC" | version u32 | entry count u32
+ *   per entry: path length u32 | path | source size u64 | source checksum u64
+ *              | payload size u64 | payload checksum u64 | payload (MessagePack)
+ *
+ * Bump FORMAT_VERSION whenever the layout, or the way documents are encoded, changes.
+ */
+static const char MAGIC[4] = {'O', 'F', 'T', 'C'};
+static const uint32_t FORMAT_VERSION = 1;
+
+struct CacheEntry {
+    uint64_t sourceSize;
+    uint64_t sourceChecksum;
+    std::vector<uint8_t> payload;
+};
+
+static std::unordered_map<std::string, CacheEntry> entries; // by source path
+static std::unordered_set<std::string> used; // entries touched this boot; everything else gets dropped
+static bool dirty = false;
+static int hits = 0;
+
+// FNV-1a, eight bytes at a time; only has to notice edits, not resist tampering
+static uint64_t checksum(const uint8_t* data, size_t size, uint64_t hash = 0xcbf29ce484222325ULL) {
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        hash ^= word;
+        hash *= 0x100000001b3ULL;
+    }
+    for (; i < size; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& out) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+
+    out.resize(file.tellg());
+    file.seekg(0);
+    file.read((char*)out.data(), out.size());
+    return (bool)file;
+}
+
+template<typename T>
+static bool take(const std::vector<uint8_t>& buf, size_t& pos, T* val) {
+    if (buf.size() - pos < sizeof(T))
+        return false;
+
+    // files are little-endian, same as every platform we build for
+    memcpy(val, &buf[pos], sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+template<typename T>
+static void put(std::ofstream& file, T val) {
+    file.write((const char*)&val, sizeof(T));
+}
+
+void TableCache::open() {
+    if (settings::TDATACACHE.empty())
+        return;
+
+    std::vector<uint8_t> buf;
+    if (!readFile(settings::TDATACACHE, buf))
+        return; // first boot
+
+    size_t pos = 0;
+    uint32_t version, count;
+    if (buf.size() < sizeof(MAGIC) || memcmp(&buf[0], MAGIC, sizeof(MAGIC)) != 0) {
+        std::cout << "[WARN] " << settings::TDATACACHE << " is not a table data cache; rebuilding it" << std::endl;
+        return;
+    }
+    pos += sizeof(MAGIC);
+
+    if (!take(buf, pos, &version) || version != FORMAT_VERSION || !take(buf, pos, &count))
+        return; // from another build; rebuilt on close()
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t pathLen;
+        uint64_t payloadSize, payloadChecksum;
+        CacheEntry entry;
+
+        if (!take(buf, pos, &pathLen) || buf.size() - pos < pathLen)
+            break;
+        std::string path((char*)&buf[pos], pathLen);
+        pos += pathLen;
+
+        if (!take(buf, pos, &entry.sourceSize) || !take(buf, pos, &entry.sourceChecksum)
+            || !take(buf, pos, &payloadSize) || !take(buf, pos, &payloadChecksum) || buf.size() - pos < payloadSize)
+            break;
+
+        entry.payload.assign(buf.begin() + pos, buf.begin() + pos + payloadSize);
+        pos += payloadSize;
+
+        if (checksum(entry.payload.data(), entry.payload.size()) != payloadChecksum) {
+            std::cout << "[WARN] Cached copy of " << path << " is corrupt; parsing it again" << std::endl;
+            continue;
+        }
+
+        entries[path] = std::move(entry);
+    }
+}
+
+static nlohmann::json parse(const std::vector<uint8_t>& source, const std::vector<std::string>& keep) {
+    nlohmann::json data = nlohmann::json::parse(source.begin(), source.end());
+    if (keep.empty())
+        return data;
+
+    nlohmann::json pruned = nlohmann::json::object();
+    for (const std::string& key : keep) {
+        auto it = data.find(key);
+        if (it != data.end())
+            pruned[key] = std::move(*it);
+    }
+    return pruned;
+}
+
+nlohmann::json TableCache::load(const std::string& path, const std::vector<std::string>& keep) {
+    std::vector<uint8_t> source;
+    if (!readFile(path, source))
+        throw std::runtime_error("could not open " + path);
+
+    if (settings::TDATACACHE.empty())
+        return parse(source, keep);
+
+    // a different set of kept tables has to invalidate the entry just like an edit would
+    uint64_t sourceChecksum = checksum(source.data(), source.size());
+    for (const std::string& key : keep)
+        sourceChecksum = checksum((const uint8_t*)key.data(), key.size() + 1, sourceChecksum);
+    used.insert(path);
+
+    auto it = entries.find(path);
+    if (it != entries.end() && it->second.sourceSize == source.size() && it->second.sourceChecksum == sourceChecksum) {
+        try {
+            nlohmann::json data = nlohmann::json::from_msgpack(it->second.payload);
+            hits++;
+            return data;
+        } catch (const std::exception& err) {
+            std::cout << "[WARN] Cached copy of " << path << " could not be decoded (" << err.what() << "); parsing it again" << std::endl;
+        }
+    }
+
+    nlohmann::json data = parse(source, keep);
+
+    CacheEntry& entry = entries[path];
+    entry.sourceSize = source.size();
+    entry.sourceChecksum = sourceChecksum;
+    entry.payload = nlohmann::json::to_msgpack(data);
+    dirty = true;
+
+    return data;
+}
+
+void TableCache::close() {
+    if (!used.empty())
+        std::cout << "[INFO] Loaded " << hits << "/" << used.size() << " table data files from cache" << std::endl;
+
+    // anything that wasn't loaded this time around is stale (a renamed file, or a different PROTOCOL_VERSION's data)
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (used.find(it->first) == used.end()) {
+            it = entries.erase(it);
+            dirty = true;
+        } else
+            it++;
+    }
+
+    if (settings::TDATACACHE.empty() || !dirty) {
+        entries.clear();
+        used.clear();
+        hits = 0;
+        return;
+    }
+
+    // write it next to the real thing first, so a crash halfway through can't leave a truncated cache behind
+    std::string tmpPath = settings::TDATACACHE + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        file.write(MAGIC, sizeof(MAGIC));
+        put<uint32_t>(file, FORMAT_VERSION);
+        put<uint32_t>(file, entries.size());
+
+        for (auto& pair : entries) {
+            CacheEntry& entry = pair.second;
+            put<uint32_t>(file, pair.first.size());
+            file.write(pair.first.data(), pair.first.size());
+            put<uint64_t>(file, entry.sourceSize);
+            put<uint64_t>(file, entry.sourceChecksum);
+            put<uint64_t>(file, entry.payload.size());
+            put<uint64_t>(file, checksum(entry.payload.data(), entry.payload.size()));
+            file.write((const char*)entry.payload.data(), entry.payload.size());
+        }
+
+        if (!file) {
+            std::cout << "[WARN] Could not write table data cache to " << tmpPath << std::endl;
+            entries.clear();
+            used.clear();
+            hits = 0;
+            dirty = false;
+            return;
+        }
+    }
+
+    std::remove(settings::TDATACACHE.c_str()); // rename() won't replace an existing file on Windows
+    if (std::rename(tmpPath.c_str(), settings::TDATACACHE.c_str()) != 0)
+        std::cout << "[WARN] Could not move table data cache into place at " << settings::TDATACACHE << std::endl;
+    else
+        std::cout << "[INFO] Wrote table data cache to " << settings::TDATACACHE << std::endl;
+
+    entries.clear();
+    used.clear();
+    hits = 0;
+    dirty = false;
+}
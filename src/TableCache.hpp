@@ -0,0 +1,23 @@
+#pragma once
+
+#include "JSON.hpp"
+
+#include <string>
+#include <vector>
+
+/*
+ * Binary cache of the parsed tabledata JSON.
+ *
+ * Parsing xdt.json and friends as text is most of the server's startup time. The first boot stores
+ * each parsed document as MessagePack in a single cache file (settings::TDATACACHE), keyed by source
+ * path along with the source's size and checksum; later boots decode that instead of parsing text.
+ * Any source that changed, or any entry that doesn't check out, just gets parsed again and replaced.
+ */
+namespace TableCache {
+    void open();
+    // parses path, or pulls it from the cache if it hasn't changed since; throws like json::parse() on bad input.
+    // if keep isn't empty, only those top-level keys are returned (and cached)
+    nlohmann::json load(const std::string& path, const std::vector<std::string>& keep = {});
+    // writes out the cache if anything had to be parsed from text
+    void close();
+}
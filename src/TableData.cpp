@@ -10,11 +10,14 @@
 #include "Vendor.hpp"
 #include "Abilities.hpp"
 #include "Eggs.hpp"
+#include "TableCache.hpp"
 
 #include "JSON.hpp"
 
 #include <fstream>
 #include <cmath>
+#include <chrono>
+#include <algorithm>
 
 using namespace TableData;
 
@@ -85,16 +88,56 @@ static void constructPathNPC(nlohmann::json::iterator _pathData, int32_t id=0, i
     Transport::NPCQueues[id] = points;
 }
 
+// only mob rows are sure to have these, and some rows have them as null
+static int32_t mobField(nlohmann::json& npc, const char* key) {
+    auto it = npc.find(key);
+    return (it != npc.end() && it->is_number()) ? (int32_t)*it : 0;
+}
+
+static void copyInts(nlohmann::json& arr, int32_t* out, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        out[i] = i < arr.size() ? (int32_t)arr[i] : 0;
+}
+
+/*
+ * Copy the fields the server uses out of a m_pMissionData entry.
+ */
+static TaskData* loadTask(nlohmann::json& task) {
+    TaskData* td = new TaskData();
+
+    td->id = task["m_iHTaskID"];
+    td->missionID = task["m_iHMissionID"];
+    td->taskType = task["m_iHTaskType"];
+    td->terminatorNPC = task["m_iHTerminatorNPCID"];
+    td->waypointNPC = task["m_iSTGrantWayPoint"];
+    td->timeLimit = task["m_iSTGrantTimer"];
+    td->nanoID = task["m_iSTNanoID"];
+    td->nextTask = task["m_iSUOutgoingTask"];
+    td->failTask = task["m_iFOutgoingTask"];
+    td->requiredInstance = task["m_iRequireInstanceID"];
+    copyInts(task["m_iHBarkerTextID"], td->barkerTextIDs, 4);
+
+    copyInts(task["m_iCSUEnemyID"], td->enemyIDs, 3);
+    copyInts(task["m_iCSUNumToKill"], td->killCounts, 3);
+    copyInts(task["m_iCSUItemID"], td->dropItemIDs, 3);
+    copyInts(task["m_iCSUItemNumNeeded"], td->dropItemCounts, 3);
+    copyInts(task["m_iSTItemDropRate"], td->dropRates, 3);
+
+    copyInts(task["m_iSTItemID"], td->startItemIDs, 3);
+    copyInts(task["m_iSTItemNumNeeded"], td->startItemCounts, 3);
+
+    copyInts(task["m_iSUItem"], td->endItemIDs, 3);
+    copyInts(task["m_iSUInstancename"], td->endItemCounts, 3);
+
+    return td;
+}
+
 /*
  * Load paths from paths JSON.
  */
 static void loadPaths(int* nextId) {
     try {
-        std::ifstream inFile(settings::PATHJSON);
-        nlohmann::json pathData;
-
-        // read file into json
-        inFile >> pathData;
+        nlohmann::json pathData = TableCache::load(settings::PATHJSON);
 
         // skyway paths
         nlohmann::json pathDataSkyway = pathData["skyway"];
@@ -203,11 +246,7 @@ static void loadPaths(int* nextId) {
  */
 static void loadDrops() {
     try {
-        std::ifstream inFile(settings::DROPSJSON);
-        nlohmann::json dropData;
-
-        // read file into json
-        inFile >> dropData;
+        nlohmann::json dropData = TableCache::load(settings::DROPSJSON);
 
         // MobDropChances
         nlohmann::json mobDropChances = dropData["MobDropChances"];
@@ -374,11 +413,7 @@ static void loadDrops() {
 
 static void loadEggs(int32_t* nextId) {
     try {
-        std::ifstream inFile(settings::EGGSJSON);
-        nlohmann::json eggData;
-
-        // read file into json
-        inFile >> eggData;
+        nlohmann::json eggData = TableCache::load(settings::EGGSJSON);
 
         // EggTypes
         nlohmann::json eggTypes = eggData["EggTypes"];
@@ -477,7 +512,7 @@ static void loadGruntwork(int32_t *nextId) {
 
             if (NPCManager::NPCData[(int)mob["iNPCType"]]["m_iTeam"] == 2) {
                 npc = new Mob(mob["iX"], mob["iY"], mob["iZ"], instanceID, mob["iNPCType"],
-                    NPCManager::NPCData[(int)mob["iNPCType"]], id);
+                    &MobAI::MobTemplates[(int)mob["iNPCType"]], id);
 
                 // re-enable respawning
                 ((Mob*)npc)->summoned = false;
@@ -496,7 +531,7 @@ static void loadGruntwork(int32_t *nextId) {
         auto groups = gruntwork["groups"];
         for (auto _group = groups.begin(); _group != groups.end(); _group++) {
             auto leader = _group.value();
-            auto td = NPCManager::NPCData[(int)leader["iNPCType"]];
+            MobTemplate* td = &MobAI::MobTemplates[(int)leader["iNPCType"]];
             uint64_t instanceID = leader.find("iMapNum") == leader.end() ? INSTANCE_OVERWORLD : (int)leader["iMapNum"];
 
             Mob* tmp = new Mob(leader["iX"], leader["iY"], leader["iZ"], leader["iAngle"], instanceID, leader["iNPCType"], td, *nextId);
@@ -517,7 +552,7 @@ static void loadGruntwork(int32_t *nextId) {
                 int followerCount = 0;
                 for (nlohmann::json::iterator _fol = followers.begin(); _fol != followers.end(); _fol++) {
                     auto follower = _fol.value();
-                    auto tdFol = NPCManager::NPCData[(int)follower["iNPCType"]];
+                    MobTemplate* tdFol = &MobAI::MobTemplates[(int)follower["iNPCType"]];
                     Mob* tmpFol = new Mob((int)leader["iX"] + (int)follower["iOffsetX"], (int)leader["iY"] + (int)follower["iOffsetY"], leader["iZ"], leader["iAngle"], instanceID, follower["iNPCType"], tdFol, *nextId);
 
                     // re-enable respawning
@@ -567,13 +602,12 @@ static void loadGruntwork(int32_t *nextId) {
 void TableData::init() {
     int32_t nextId = 0;
 
+    auto start = std::chrono::steady_clock::now();
+    TableCache::open();
+
     // load NPCs from NPC.json
     try {
-        std::ifstream inFile(settings::NPCJSON);
-        nlohmann::json npcData;
-
-        // read file into json
-        inFile >> npcData;
+        nlohmann::json npcData = TableCache::load(settings::NPCJSON);
         npcData = npcData["NPCs"];
         for (nlohmann::json::iterator _npc = npcData.begin(); _npc != npcData.end(); _npc++) {
             auto npc = _npc.value();
@@ -601,17 +635,52 @@ void TableData::init() {
     }
 
     // load everything else from xdttable
-    std::cout << "[INFO] Parsing xdt.json..." << std::endl;
-    std::ifstream infile(settings::XDTJSON);
-    nlohmann::json xdtData;
-
-    // read file into json
-    infile >> xdtData;
+    std::cout << "[INFO] Loading xdt.json..." << std::endl;
+    // only the tables read below; the rest of xdt.json is never looked at, so it's not worth caching
+    nlohmann::json xdtData = TableCache::load(settings::XDTJSON, {
+        "m_pNpcTable", "m_pInstanceTable", "m_pTransportationTable", "m_pMissionTable",
+        "m_pWeaponItemTable", "m_pShirtsItemTable", "m_pPantsItemTable", "m_pShoesItemTable", "m_pHatItemTable",
+        "m_pGlassItemTable", "m_pBackItemTable", "m_pGeneralItemTable", "m_pChestItemTable", "m_pVehicleItemTable",
+        "m_pAvatarTable", "m_pVendorTable", "m_pCombiningTable", "m_pNanoTable", "m_pSkillTable"
+    });
 
     // data we'll need for summoned mobs
     NPCManager::NPCData = xdtData["m_pNpcTable"]["m_pNpcData"];
 
     try {
+        // typed copies of the fields mobs use, so combat and AI don't go through the json
+        for (nlohmann::json::iterator _npc = NPCManager::NPCData.begin(); _npc != NPCManager::NPCData.end(); _npc++) {
+            auto npc = _npc.value();
+            MobTemplate tmpl = {};
+
+            tmpl.maxHealth = mobField(npc, "m_iHP");
+            tmpl.sightRange = mobField(npc, "m_iSightRange");
+            tmpl.regenTime = mobField(npc, "m_iRegenTime");
+            tmpl.idleRange = mobField(npc, "m_iIdleRange");
+            tmpl.dropType = mobField(npc, "m_iDropType");
+            tmpl.level = mobField(npc, "m_iNpcLevel");
+
+            tmpl.power = mobField(npc, "m_iPower");
+            tmpl.protection = mobField(npc, "m_iProtection");
+            tmpl.style = mobField(npc, "m_iNpcStyle");
+            tmpl.atkRange = mobField(npc, "m_iAtkRange");
+            tmpl.radius = mobField(npc, "m_iRadius");
+            tmpl.combatRange = mobField(npc, "m_iCombatRange");
+            tmpl.delayTime = mobField(npc, "m_iDelayTime");
+            tmpl.walkSpeed = mobField(npc, "m_iWalkSpeed");
+            tmpl.runSpeed = mobField(npc, "m_iRunSpeed");
+
+            tmpl.activeSkill1 = mobField(npc, "m_iActiveSkill1");
+            tmpl.activeSkill1Prob = mobField(npc, "m_iActiveSkill1Prob");
+            tmpl.corruptionType = mobField(npc, "m_iCorruptionType");
+            tmpl.corruptionTypeProb = mobField(npc, "m_iCorruptionTypeProb");
+            tmpl.megaType = mobField(npc, "m_iMegaType");
+            tmpl.megaTypeProb = mobField(npc, "m_iMegaTypeProb");
+            tmpl.passiveBuff = mobField(npc, "m_iPassiveBuff");
+
+            MobAI::MobTemplates.push_back(tmpl);
+        }
+
         // load warps
         nlohmann::json warpData = xdtData["m_pInstanceTable"]["m_pWarpData"];
 
@@ -677,8 +746,17 @@ void TableData::init() {
                 Missions::Rewards[task["m_iHTaskID"]] = rew;
             }
 
-            // everything else lol. see TaskData comment.
-            Missions::Tasks[task["m_iHTaskID"]] = new TaskData(task);
+            TaskData* td = loadTask(task);
+            Missions::Tasks[td->id] = td;
+
+            for (int j = 0; j < 3; j++) {
+                if (td->enemyIDs[j] == 0)
+                    continue;
+
+                std::vector<int32_t>& interested = Missions::EnemyTasks[td->enemyIDs[j]];
+                if (std::find(interested.begin(), interested.end(), td->id) == interested.end())
+                    interested.push_back(td->id);
+            }
         }
         std::cout << "[INFO] Loaded " << Transport::Locations.size() << " S.C.A.M.P.E.R. locations" << std::endl;
 
@@ -811,18 +889,14 @@ void TableData::init() {
 
     // load mobs
     try {
-        std::ifstream inFile(settings::MOBJSON);
-        nlohmann::json npcData, groupData;
-
-        // read file into json
-        inFile >> npcData;
-        groupData = npcData["groups"];
+        nlohmann::json npcData = TableCache::load(settings::MOBJSON);
+        nlohmann::json groupData = npcData["groups"];
         npcData = npcData["mobs"];
 
         // single mobs
         for (nlohmann::json::iterator _npc = npcData.begin(); _npc != npcData.end(); _npc++) {
             auto npc = _npc.value();
-            auto td = NPCManager::NPCData[(int)npc["iNPCType"]];
+            MobTemplate* td = &MobAI::MobTemplates[(int)npc["iNPCType"]];
             uint64_t instanceID = npc.find("iMapNum") == npc.end() ? INSTANCE_OVERWORLD : (int)npc["iMapNum"];
 
 #ifdef ACADEMY
@@ -846,7 +920,7 @@ void TableData::init() {
         // single mobs
         for (nlohmann::json::iterator _group = groupData.begin(); _group != groupData.end(); _group++) {
             auto leader = _group.value();
-            auto td = NPCManager::NPCData[(int)leader["iNPCType"]];
+            MobTemplate* td = &MobAI::MobTemplates[(int)leader["iNPCType"]];
             uint64_t instanceID = leader.find("iMapNum") == leader.end() ? INSTANCE_OVERWORLD : (int)leader["iMapNum"];
             auto followers = leader["aFollowers"];
 
@@ -873,7 +947,7 @@ void TableData::init() {
                 int followerCount = 0;
                 for (nlohmann::json::iterator _fol = followers.begin(); _fol != followers.end(); _fol++) {
                     auto follower = _fol.value();
-                    auto tdFol = NPCManager::NPCData[(int)follower["iNPCType"]];
+                    MobTemplate* tdFol = &MobAI::MobTemplates[(int)follower["iNPCType"]];
                     Mob* tmpFol = new Mob((int)leader["iX"] + (int)follower["iOffsetX"], (int)leader["iY"] + (int)follower["iOffsetY"], leader["iZ"], leader["iAngle"], instanceID, follower["iNPCType"], tdFol, nextId);
 
                     NPCManager::NPCs[nextId] = tmpFol;
@@ -900,10 +974,7 @@ void TableData::init() {
     }
 
     try {
-        std::ifstream inFile(settings::VENDORJSON);
-        nlohmann::json vendorData;
-
-        inFile >> vendorData;
+        nlohmann::json vendorData = TableCache::load(settings::VENDORJSON);
 
         nlohmann::json listings = vendorData["m_pItemData"];
 
@@ -923,11 +994,7 @@ void TableData::init() {
 #ifdef ACADEMY
     // load Academy NPCs from academy.json
     try {
-        std::ifstream inFile(settings::ACADEMYJSON);
-        nlohmann::json npcData;
-
-        // read file into json
-        inFile >> npcData;
+        nlohmann::json npcData = TableCache::load(settings::ACADEMYJSON);
         npcData = npcData["NPCs"];
         for (nlohmann::json::iterator _npc = npcData.begin(); _npc != npcData.end(); _npc++) {
             auto npc = _npc.value();
@@ -936,7 +1003,7 @@ void TableData::init() {
             int team = NPCManager::NPCData[(int)npc["iNPCType"]]["m_iTeam"];
 
             if (team == 2) {
-                NPCManager::NPCs[nextId] = new Mob(npc["iX"], npc["iY"], npc["iZ"], npc["iAngle"], instanceID, npc["iNPCType"], NPCManager::NPCData[(int)npc["iNPCType"]], nextId);
+                NPCManager::NPCs[nextId] = new Mob(npc["iX"], npc["iY"], npc["iZ"], npc["iAngle"], instanceID, npc["iNPCType"], &MobAI::MobTemplates[(int)npc["iNPCType"]], nextId);
                 MobAI::Mobs[nextId] = (Mob*)NPCManager::NPCs[nextId];
             } else
                 NPCManager::NPCs[nextId] = new BaseNPC(npc["iX"], npc["iY"], npc["iZ"], npc["iAngle"], instanceID, npc["iNPCType"], nextId);
@@ -960,8 +1027,13 @@ void TableData::init() {
 
     loadPaths(&nextId); // load paths
 
+    TableCache::close();
+
     loadGruntwork(&nextId);
 
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << "[INFO] Loaded table data in " << elapsed.count() << "ms" << std::endl;
+
     NPCManager::nextId = nextId;
 }
 
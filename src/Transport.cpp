@@ -14,7 +14,7 @@ using namespace Transport;
 std::map<int32_t, TransportRoute> Transport::Routes;
 std::map<int32_t, TransportLocation> Transport::Locations;
 std::map<int32_t, std::queue<WarpLocation>> Transport::SkywayPaths;
-std::unordered_map<CNSocket*, std::queue<WarpLocation>> Transport::SkywayQueues;
+std::unordered_map<EntityHandle, std::queue<WarpLocation>> Transport::SkywayQueues;
 std::unordered_map<int32_t, std::queue<WarpLocation>> Transport::NPCQueues;
 
 static void transportRegisterLocationHandler(CNSocket* sock, CNPacketData* data) {
@@ -133,7 +133,7 @@ static void transportWarpHandler(CNSocket* sock, CNPacketData* data) {
         plr->lastZ = plr->z;
         if (SkywayPaths.find(route.mssRouteNum) != SkywayPaths.end()) { // check if route exists
             Nanos::summonNano(sock, -1); // make sure that no nano is active during the ride
-            SkywayQueues[sock] = SkywayPaths[route.mssRouteNum]; // set socket point queue to route
+            SkywayQueues[plr->handle] = SkywayPaths[route.mssRouteNum]; // set player point queue to route
             plr->onMonkey = true;
             break;
         } else if (TableData::RunningSkywayRoutes.find(route.mssRouteNum) != TableData::RunningSkywayRoutes.end()) {
@@ -187,28 +187,29 @@ void Transport::testMssRoute(CNSocket *sock, std::vector<WarpLocation>* route) {
         last = coords; // update start pos
     }
 
-    SkywayQueues[sock] = path;
+    SkywayQueues[PlayerManager::getHandle(sock)] = path;
 }
 
 /*
- * Go through every socket that has broomstick points queued up, and advance to the next point.
+ * Go through every player that has broomstick points queued up, and advance to the next point.
  * If the player has disconnected or finished the route, clean up and remove them from the queue.
  */
 static void stepSkywaySystem() {
 
     // using an unordered map so we can remove finished players in one iteration
-    std::unordered_map<CNSocket*, std::queue<WarpLocation>>::iterator it = SkywayQueues.begin();
+    std::unordered_map<EntityHandle, std::queue<WarpLocation>>::iterator it = SkywayQueues.begin();
     while (it != SkywayQueues.end()) {
 
         std::queue<WarpLocation>* queue = &it->second;
+        CNSocket* sock = PlayerManager::getSockFromHandle(it->first);
 
-        if (PlayerManager::players.find(it->first) == PlayerManager::players.end()) {
-            // pluck out dead socket + update iterator
+        if (sock == nullptr) {
+            // pluck out player who left + update iterator
             it = SkywayQueues.erase(it);
             continue;
         }
 
-        Player* plr = PlayerManager::getPlayer(it->first);
+        Player* plr = PlayerManager::getPlayer(sock);
 
         if (queue->empty()) {
             // send dismount packet
@@ -218,9 +219,9 @@ static void stepSkywaySystem() {
             rideSucc.eRT = 0;
             rideBroadcast.iPC_ID = plr->iID;
             rideBroadcast.eRT = 0;
-            it->first->sendPacket((void*)&rideSucc, P_FE2CL_REP_PC_RIDING_SUCC, sizeof(sP_FE2CL_REP_PC_RIDING_SUCC));
+            sock->sendPacket((void*)&rideSucc, P_FE2CL_REP_PC_RIDING_SUCC, sizeof(sP_FE2CL_REP_PC_RIDING_SUCC));
             // send packet to players in view
-            PlayerManager::sendToViewable(it->first, (void*)&rideBroadcast, P_FE2CL_PC_RIDING, sizeof(sP_FE2CL_PC_RIDING));
+            PlayerManager::sendToViewable(sock, (void*)&rideBroadcast, P_FE2CL_PC_RIDING, sizeof(sP_FE2CL_PC_RIDING));
             it = SkywayQueues.erase(it); // remove player from tracking map + update iterator
             plr->onMonkey = false;
         } else {
@@ -232,11 +233,11 @@ static void stepSkywaySystem() {
             bmstk.iToX = point.x;
             bmstk.iToY = point.y;
             bmstk.iToZ = point.z;
-            it->first->sendPacket((void*)&bmstk, P_FE2CL_PC_BROOMSTICK_MOVE, sizeof(sP_FE2CL_PC_BROOMSTICK_MOVE));
+            sock->sendPacket((void*)&bmstk, P_FE2CL_PC_BROOMSTICK_MOVE, sizeof(sP_FE2CL_PC_BROOMSTICK_MOVE));
             // set player location to point to update viewables
-            PlayerManager::updatePlayerPosition(it->first, point.x, point.y, point.z, plr->instanceID, plr->angle);
+            PlayerManager::updatePlayerPosition(sock, point.x, point.y, point.z, plr->instanceID, plr->angle);
             // send packet to players in view
-            PlayerManager::sendToViewable(it->first, (void*)&bmstk, P_FE2CL_PC_BROOMSTICK_MOVE, sizeof(sP_FE2CL_PC_BROOMSTICK_MOVE));
+            PlayerManager::sendToViewable(sock, (void*)&bmstk, P_FE2CL_PC_BROOMSTICK_MOVE, sizeof(sP_FE2CL_PC_BROOMSTICK_MOVE));
 
             it++; // go to next entry in map
         }
@@ -2,6 +2,7 @@
 
 #include "servers/CNShardServer.hpp"
 #include "NPCManager.hpp"
+#include "core/HandleTable.hpp"
 
 #include <unordered_map>
 
@@ -23,7 +24,7 @@ namespace Transport {
     extern std::map<int32_t, TransportRoute> Routes;
     extern std::map<int32_t, TransportLocation> Locations;
     extern std::map<int32_t, std::queue<WarpLocation>> SkywayPaths; // predefined skyway paths with points
-    extern std::unordered_map<CNSocket*, std::queue<WarpLocation>> SkywayQueues; // player sockets with queued broomstick points
+    extern std::unordered_map<EntityHandle, std::queue<WarpLocation>> SkywayQueues; // players with queued broomstick points
     extern std::unordered_map<int32_t, std::queue<WarpLocation>> NPCQueues; // NPC ids with queued pathing points
 
     void init();
@@ -0,0 +1,151 @@
+#include "core/CNProtocol.hpp"
+
+// vectorized encryption kernels are picked at runtime on x86 GCC/Clang builds
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define OF_X86_SIMD
+    #include <immintrin.h>
+#endif
+
+// literally C/P from the client and converted to C++ (does some byte swapping /shrug)
+int CNSocketEncryption::Encrypt_byte_change_A(int ERSize, uint8_t* data, int size) {
+    int num = 0;
+    int num2 = 0;
+    int num3 = 0;
+
+    while (num + ERSize <= size) {
+        int num4 = num + num3;
+        int num5 = num + (ERSize - 1 - num3);
+
+        uint8_t b = data[num4];
+        data[num4] = data[num5];
+        data[num5] = b;
+        num += ERSize;
+        num3++;
+        if (num3 > ERSize / 2) {
+            num3 = 0;
+        }
+    }
+
+    num2 = ERSize - (num + ERSize - size);
+    return num + num2;
+}
+
+/*
+ * The key is exactly one 64-bit word long, so it lines up with every word of the
+ * buffer (and with every 16/32-byte vector, since those are multiples of 8).
+ * Each implementation handles what it can and passes the rest down the chain.
+ */
+static int xorDataBytes(uint8_t* buffer, uint8_t* key, int size) {
+    for (int i = 0; i < size; i++) {
+        buffer[i] ^= key[i % CNSocketEncryption::keyLength];
+    }
+
+    return size;
+}
+
+static int xorDataWords(uint8_t* buffer, uint8_t* key, int size) {
+    uint64_t k;
+    memcpy(&k, key, sizeof(k));
+
+    int i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, buffer + i, sizeof(word));
+        word ^= k;
+        memcpy(buffer + i, &word, sizeof(word));
+    }
+
+    xorDataBytes(buffer + i, key, size - i);
+    return size;
+}
+
+#ifdef OF_X86_SIMD
+__attribute__((target("sse2")))
+static int xorDataSSE2(uint8_t* buffer, uint8_t* key, int size) {
+    uint64_t k;
+    memcpy(&k, key, sizeof(k));
+    __m128i vkey = _mm_set1_epi64x(k);
+
+    int i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128((__m128i*)(buffer + i));
+        _mm_storeu_si128((__m128i*)(buffer + i), _mm_xor_si128(v, vkey));
+    }
+
+    xorDataWords(buffer + i, key, size - i);
+    return size;
+}
+
+__attribute__((target("avx2")))
+static int xorDataAVX2(uint8_t* buffer, uint8_t* key, int size) {
+    uint64_t k;
+    memcpy(&k, key, sizeof(k));
+    __m256i vkey = _mm256_set1_epi64x(k);
+
+    int i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256((__m256i*)(buffer + i));
+        _mm256_storeu_si256((__m256i*)(buffer + i), _mm256_xor_si256(v, vkey));
+    }
+
+    xorDataSSE2(buffer + i, key, size - i);
+    return size;
+}
+#endif
+
+typedef int (*XorHandler)(uint8_t* buffer, uint8_t* key, int size);
+
+// picks the widest implementation the CPU we're running on supports
+static XorHandler selectXorHandler() {
+#ifdef OF_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return xorDataAVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return xorDataSSE2;
+#endif
+    return xorDataWords;
+}
+
+int CNSocketEncryption::xorData(uint8_t* buffer, uint8_t* key, int size) {
+    static XorHandler handler = selectXorHandler();
+
+    // xor every 8 bytes with 8 byte key
+    return handler(buffer, key, size);
+}
+
+uint32_t CNSocketEncryption::validateSum(uint8_t* buffer, uint32_t type, int size) {
+    int num = 0;
+    int num2 = 0;
+    int num3 = iV >> 20; // 255
+
+    for (int i = 0;/*iV & 0xF*/ i < size; i++) {
+        num += buffer[i];
+        num -= num3 * (num / num3);
+        num2 += num;
+        num2 -= num3 * (num2 / num3);
+    }
+
+    int dataSum = ((num2 << ((iV >> 12) & 0xF)) | num) & (iV >> 16);
+    // std::cout << "Calculated sum: " << dataSum << std::endl;
+    return type | (dataSum << 12);
+}
+
+uint64_t CNSocketEncryption::createNewKey(uint64_t uTime, int32_t iv1, int32_t iv2) {
+    uint64_t num = (uint64_t)(iv1 + 1);
+    uint64_t num2 = (uint64_t)(iv2 + 1);
+    uint64_t dEKey = (uint64_t)(*(uint64_t*)&defaultKey[0]);
+    return dEKey * (uTime * num * num2);
+}
+
+int CNSocketEncryption::encryptData(uint8_t* buffer, uint8_t* key, int size) {
+    int eRSize = size % (keyLength / 2 + 1) * 2 + keyLength; // C/P from client
+    int size2 = xorData(buffer, key, size);
+    return Encrypt_byte_change_A(eRSize, buffer, size2);
+}
+
+int CNSocketEncryption::decryptData(uint8_t* buffer, uint8_t* key, int size) {
+    int eRSize = size % (keyLength / 2 + 1) * 2 + keyLength; // size % of 18????
+    int size2 = Encrypt_byte_change_A(eRSize, buffer, size);
+    return xorData(buffer, key, size2);
+}
@@ -1,107 +1,174 @@
 #include "core/CNProtocol.hpp"
+#include "core/EventLoop.hpp"
 #include "CNStructs.hpp"
 
 #include <assert.h>
 
-// ========================================================[[ CNSocketEncryption ]]========================================================
-
-// literally C/P from the client and converted to C++ (does some byte swapping /shrug)
-int CNSocketEncryption::Encrypt_byte_change_A(int ERSize, uint8_t* data, int size) {
-    int num = 0;
-    int num2 = 0;
-    int num3 = 0;
-
-    while (num + ERSize <= size) {
-        int num4 = num + num3;
-        int num5 = num + (ERSize - 1 - num3);
-
-        uint8_t b = data[num4];
-        data[num4] = data[num5];
-        data[num5] = b;
-        num += ERSize;
-        num3++;
-        if (num3 > ERSize / 2) {
-            num3 = 0;
-        }
-    }
+// ========================================================[[ CNPacketData ]]========================================================
 
-    num2 = ERSize - (num + ERSize - size);
-    return num + num2;
-}
+CNPacketData::CNPacketData(void* b, uint32_t t, int l): buf(b), size(l), type(t) {}
+
+// ========================================================[[ CNBroadcastPacket ]]========================================================
+
+CNBroadcastPacket::CNBroadcastPacket(void* b, uint32_t t, size_t l): buf(b), type(t), size(l) {}
+
+// returns the full frame (length, type, body) encrypted with key
+uint8_t* CNBroadcastPacket::encrypt(uint64_t key) {
+    if (encrypted && key == cipherKey)
+        return cipherFrame;
+
+    if (frameSize == 0) {
+        // same layout as CNSocket::sendPacket()
+        uint32_t fullType = CNSocketEncryption::validateSum((uint8_t*)buf, type, (int)size);
+        uint32_t bodysize = size + 4;
 
-int CNSocketEncryption::xorData(uint8_t* buffer, uint8_t* key, int size) {
-    // xor every 8 bytes with 8 byte key
-    for (int i = 0; i < size; i++) {
-        buffer[i] ^= key[i % keyLength];
+        memcpy(plainFrame, (void*)&bodysize, 4);
+        memcpy(plainFrame+4, (void*)&fullType, 4);
+        memcpy(plainFrame+8, buf, size);
+        frameSize = bodysize + 4;
     }
 
-    return size;
+    memcpy(cipherFrame, plainFrame, frameSize);
+    CNSocketEncryption::encryptData(cipherFrame+4, (uint8_t*)&key, frameSize-4);
+
+    cipherKey = key;
+    encrypted = true;
+    return cipherFrame;
 }
 
-uint32_t CNSocketEncryption::validateSum(uint8_t* buffer, uint32_t type, int size) {
-    int num = 0;
-    int num2 = 0;
-    int num3 = iV >> 20; // 255
+// ========================================================[[ CNRingBuffer ]]========================================================
+
+CNRingBuffer::~CNRingBuffer() {
+    free(data);
+}
 
-    for (int i = 0;/*iV & 0xF*/ i < size; i++) {
-        num += buffer[i];
-        num -= num3 * (num / num3);
-        num2 += num;
-        num2 -= num3 * (num2 / num3);
+void CNRingBuffer::grow(size_t needed) {
+    size_t newCapacity = capacity == 0 ? CN_PACKET_BUFFER_SIZE * 2 : capacity;
+    while (newCapacity < needed)
+        newCapacity *= 2;
+
+    uint8_t* newData = (uint8_t*)xmalloc(newCapacity);
+
+    // linearize the existing contents at the start of the new buffer
+    uint8_t* ptrs[2];
+    size_t lens[2];
+    size_t offset = 0;
+    int n = spans(ptrs, lens);
+    for (int i = 0; i < n; i++) {
+        memcpy(newData + offset, ptrs[i], lens[i]);
+        offset += lens[i];
     }
 
-    int dataSum = ((num2 << ((iV >> 12) & 0xF)) | num) & (iV >> 16);
-    // std::cout << "Calculated sum: " << dataSum << std::endl;
-    return type | (dataSum << 12);
+    free(data);
+    data = newData;
+    capacity = newCapacity;
+    head = 0;
 }
 
-uint64_t CNSocketEncryption::createNewKey(uint64_t uTime, int32_t iv1, int32_t iv2) {
-    uint64_t num = (uint64_t)(iv1 + 1);
-    uint64_t num2 = (uint64_t)(iv2 + 1);
-    uint64_t dEKey = (uint64_t)(*(uint64_t*)&defaultKey[0]);
-    return dEKey * (uTime * num * num2);
-}
+void CNRingBuffer::push(uint8_t* buf, size_t len) {
+    if (used + len > capacity)
+        grow(used + len);
 
-int CNSocketEncryption::encryptData(uint8_t* buffer, uint8_t* key, int size) {
-    int eRSize = size % (keyLength / 2 + 1) * 2 + keyLength; // C/P from client
-    int size2 = xorData(buffer, key, size);
-    return Encrypt_byte_change_A(eRSize, buffer, size2);
+    size_t tail = (head + used) & (capacity - 1);
+    size_t first = std::min(len, capacity - tail);
+
+    memcpy(data + tail, buf, first);
+    memcpy(data, buf + first, len - first); // wrapped part, if any
+    used += len;
 }
 
-int CNSocketEncryption::decryptData(uint8_t* buffer, uint8_t* key, int size) {
-    int eRSize = size % (keyLength / 2 + 1) * 2 + keyLength; // size % of 18????
-    int size2 = Encrypt_byte_change_A(eRSize, buffer, size);
-    return xorData(buffer, key, size2);
+void CNRingBuffer::pop(size_t len) {
+    assert(len <= used);
+
+    used -= len;
+    head = used == 0 ? 0 : (head + len) & (capacity - 1);
 }
 
-// ========================================================[[ CNPacketData ]]========================================================
+int CNRingBuffer::spans(uint8_t** ptrs, size_t* lens) {
+    if (used == 0)
+        return 0;
 
-CNPacketData::CNPacketData(void* b, uint32_t t, int l): buf(b), size(l), type(t) {}
+    size_t first = std::min(used, capacity - head);
+    ptrs[0] = data + head;
+    lens[0] = first;
+
+    if (first == used)
+        return 1;
+
+    ptrs[1] = data;
+    lens[1] = used - first;
+    return 2;
+}
 
 // ========================================================[[ CNSocket ]]========================================================
 
-CNSocket::CNSocket(SOCKET s, struct sockaddr_in &addr, PacketHandler ph): sock(s), sockaddr(addr), pHandler(ph) {
+CNSocket::CNSocket(SOCKET s, struct sockaddr_in &addr, PacketHandler ph, std::vector<CNSocket*>* fq): flushQueue(fq), sock(s), sockaddr(addr), pHandler(ph) {
     EKey = (uint64_t)(*(uint64_t*)&CNSocketEncryption::defaultKey[0]);
 }
 
-bool CNSocket::sendData(uint8_t* data, int size) {
-    int sentBytes = 0;
-    int maxTries = 10;
+// the descriptor is only released here, so it can't be reused while the server still tracks it
+CNSocket::~CNSocket() {
+#ifdef _WIN32
+    closesocket(sock);
+#else
+    close(sock);
+#endif
+}
 
-    while (sentBytes < size) {
-        int sent = send(sock, (buffer_t*)(data + sentBytes), size - sentBytes, 0);
-        if (SOCKETERROR(sent)) {
-            if (OF_ERRNO == OF_EWOULD && maxTries > 0) {
-                maxTries--;
-                continue; // try again
+/*
+ * Writes out as much of the send buffer as the kernel will take.
+ * Returns true if everything was sent, false if we need to wait for POLLOUT.
+ */
+bool CNSocket::flush() {
+    flushQueued = false;
+
+    if (!alive)
+        return true;
+
+    while (sendBuffer.size() > 0) {
+        uint8_t* ptrs[2];
+        size_t lens[2];
+        int n = sendBuffer.spans(ptrs, lens);
+
+#ifdef _WIN32
+        WSABUF bufs[2];
+        for (int i = 0; i < n; i++) {
+            bufs[i].buf = (CHAR*)ptrs[i];
+            bufs[i].len = (ULONG)lens[i];
+        }
+
+        DWORD sent = 0;
+        bool failed = SOCKETERROR(WSASend(sock, bufs, n, &sent, 0, NULL, NULL));
+#else
+        struct iovec iov[2];
+        for (int i = 0; i < n; i++) {
+            iov[i].iov_base = ptrs[i];
+            iov[i].iov_len = lens[i];
+        }
+
+        ssize_t sent = writev(sock, iov, n);
+        bool failed = SOCKETERROR(sent);
+#endif
+
+        if (failed) {
+            if (OF_ERRNO == OF_EWOULD) {
+                // it's still keeping up as long as it's back under the high-water mark
+                if (sendBuffer.size() <= (size_t)settings::SENDBUFFERLIMIT)
+                    congestedSince = 0;
+                return false; // kernel buffer is full; try again once the socket is writable
             }
-            printSocketError("send");
-            return false; // error occured while sending bytes
+
+            printSocketError("writev");
+            sendBuffer.pop(sendBuffer.size());
+            kill();
+            return true;
         }
-        sentBytes += sent;
+
+        sendBuffer.pop(sent);
     }
 
-    return true; // it worked!
+    congestedSince = 0;
+    return true;
 }
 
 void CNSocket::setEKey(uint64_t k) {
@@ -124,14 +191,24 @@ bool CNSocket::isAlive() {
     return alive;
 }
 
+bool CNSocket::isFlushQueued() {
+    return flushQueued;
+}
+
+/*
+ * The socket is shut down but not closed; the resulting hangup event lets the
+ * server notice it and clean the connection up, then the destructor closes it.
+ */
 void CNSocket::kill() {
+    // make a best-effort attempt to get out whatever was queued before this (ex. disconnect notices)
+    if (alive)
+        flush();
+
     alive = false;
 #ifdef _WIN32
     shutdown(sock, SD_BOTH);
-    closesocket(sock);
 #else
     shutdown(sock, SHUT_RDWR);
-    close(sock);
 #endif
 }
 
@@ -174,82 +251,131 @@ void CNSocket::sendPacket(void* buf, uint32_t type, size_t size) {
         return;
     }
 
-    // send packet data!
-    if (alive && !sendData(fullpkt, bodysize+4))
-        kill();
+    queueData(fullpkt, bodysize+4);
 }
 
-void CNSocket::setActiveKey(ACTIVEKEY key) {
-    activeKey = key;
+void CNSocket::sendPacket(CNBroadcastPacket& pkt) {
+    if (!alive)
+        return;
+
+    switch (activeKey) {
+    case SOCKETKEY_E:
+        queueData(pkt.encrypt(EKey), pkt.getFrameSize());
+        break;
+    case SOCKETKEY_FE:
+        queueData(pkt.encrypt(FEKey), pkt.getFrameSize());
+        break;
+    default:
+        DEBUGLOG(
+            std::cout << "[WARN]: UNSET KEYTYPE FOR SOCKET!! ABORTING SEND" << std::endl;
+        )
+        return;
+    }
 }
 
-void CNSocket::step() {
-    // read step
+// queues an encrypted frame; it's written out along with everything else once per loop iteration
+void CNSocket::queueData(uint8_t* data, size_t size) {
+    sendBuffer.push(data, size);
 
-    // XXX NOTE: we must not recv() twice without a poll() inbetween
-    if (readSize <= 0) {
-        // we aren't reading a packet yet, try to start looking for one
-        int recved = recv(sock, (buffer_t*)readBuffer, sizeof(int32_t), 0);
-        if (recved == 0) {
-            // the socket was closed normally
-            kill();
-        } else if (!SOCKETERROR(recved)) {
-            // we got our packet size!!!!
-            readSize = *((int32_t*)readBuffer);
-            // sanity check
-            if (readSize > CN_PACKET_BUFFER_SIZE) {
-                kill();
-                return;
-            }
+    if (flushQueue == nullptr) {
+        flush();
+        return;
+    }
+
+    if (!flushQueued) {
+        flushQueue->push_back(this);
+        flushQueued = true;
+    }
+
+    // disconnect clients that haven't been keeping up with what we send them for a while
+    if (settings::SENDBUFFERLIMIT > 0 && sendBuffer.size() > (size_t)settings::SENDBUFFERLIMIT) {
+        time_t currTime = getTime();
 
-            // we'll just leave bufferIndex at 0 since we already have the packet size, it's safe to overwrite those bytes
-            activelyReading = true;
-        } else if (OF_ERRNO != OF_EWOULD) {
-            // serious socket issue, disconnect connection
-            printSocketError("recv");
+        if (congestedSince == 0) {
+            congestedSince = currTime;
+        } else if (currTime - congestedSince > settings::SENDBUFFERTIMEOUT) {
+            std::cout << "[WARN] Disconnecting " << inet_ntoa(sockaddr.sin_addr) << ": send buffer full for too long" << std::endl;
+            sendBuffer.pop(sendBuffer.size());
             kill();
-            return;
         }
+    } else {
+        congestedSince = 0;
     }
+}
 
-    if (readSize > 0 && readBufferIndex < readSize) {
-        // read until the end of the packet! (or at least try too)
-        int recved = recv(sock, (buffer_t*)(readBuffer + readBufferIndex), readSize - readBufferIndex, 0);
-        if (recved == 0) {
-            // the socket was closed normally
-            kill();
-        } else if (!SOCKETERROR(recved))
-            readBufferIndex += recved;
-        else if (OF_ERRNO != OF_EWOULD) {
-            // serious socket issue, disconnect connection
-            printSocketError("recv");
+void CNSocket::setActiveKey(ACTIVEKEY key) {
+    activeKey = key;
+}
+
+/*
+ * Reads whatever the socket has (up to the size of the read buffer) and handles
+ * every complete packet in it; partial packets are kept until the rest arrives.
+ *
+ * Returns true if there might be more data to read. Level-triggered backends
+ * ignore this and wait for the next poll(); edge-triggered ones keep stepping
+ * until it returns false.
+ */
+bool CNSocket::step() {
+    // read step
+    int recved = recv(sock, (buffer_t*)(readBuffer + readBufferIndex), sizeof(readBuffer) - readBufferIndex, 0);
+    if (recved == 0) {
+        // the socket was closed normally
+        kill();
+        return false;
+    } else if (SOCKETERROR(recved)) {
+        if (OF_ERRNO == OF_EWOULD)
+            return false; // drained
+
+        // serious socket issue, disconnect connection
+        printSocketError("recv");
+        kill();
+        return false;
+    }
+
+    readBufferIndex += recved;
+    bool more = readBufferIndex == sizeof(readBuffer); // we filled the buffer, so there's probably more waiting
+
+    int offset = 0;
+    while (alive && readBufferIndex - offset >= (int)sizeof(int32_t)) {
+        int32_t readSize = *((int32_t*)(readBuffer + offset));
+
+        // sanity check
+        if (readSize > CN_PACKET_BUFFER_SIZE || readSize < (int32_t)sizeof(uint32_t)) {
             kill();
-            return;
+            return false;
         }
-    }
 
-    if (activelyReading && readBufferIndex >= readSize) {
-        // decrypt readBuffer and copy to CNPacketData
-        CNSocketEncryption::decryptData((uint8_t*)&readBuffer, (uint8_t*)(&EKey), readSize);
+        if (readBufferIndex - offset - (int)sizeof(int32_t) < readSize)
+            break; // we don't have the whole packet yet
 
+        uint8_t* packet = readBuffer + offset + sizeof(int32_t);
 
-        // std::cout << "\n\nReceiving packet! Contents: " << std::endl;
-        // for (int i = 0; i < readSize; i++) {
-        //     printf("%02x ", readBuffer[i]);
-        // }
-        // std::cout << std::endl;
-        void* tmpBuf = readBuffer+sizeof(uint32_t);
-        CNPacketData tmp(tmpBuf, *((uint32_t*)readBuffer) & 0xFF000FFF, readSize-sizeof(int32_t));
-        // std::cout << "Packet type: " << (*((uint32_t*)readBuffer) & 0xFF000FFF) << std::endl;
+        // decrypt the packet in place and wrap it in CNPacketData
+        CNSocketEncryption::decryptData(packet, (uint8_t*)(&EKey), readSize);
+
+        void* tmpBuf = packet+sizeof(uint32_t);
+        CNPacketData tmp(tmpBuf, *((uint32_t*)packet) & 0xFF000FFF, readSize-sizeof(int32_t));
 
         // call packet handler!!
         pHandler(this, &tmp);
 
-        // reset vars :)
-        readSize = 0;
-        readBufferIndex = 0;
-        activelyReading = false;
+        offset += sizeof(int32_t) + readSize;
+
+        // handlers expect their structs to be 4-byte aligned, so realign the rest if needed
+        if (offset % 4 != 0) {
+            memmove(readBuffer, readBuffer + offset, readBufferIndex - offset);
+            readBufferIndex -= offset;
+            offset = 0;
+        }
+    }
+
+    // move the leftover partial packet to the front
+    if (offset > 0) {
+        memmove(readBuffer, readBuffer + offset, readBufferIndex - offset);
+        readBufferIndex -= offset;
     }
+
+    return more && alive;
 }
 
 void printSocketError(const char *call) {
@@ -359,32 +485,30 @@ void CNServer::init() {
         exit(EXIT_FAILURE);
     }
 
-    // poll() configuration
-    fds.reserve(STARTFDSCOUNT);
-    fds.push_back({sock, POLLIN});
+    // event loop configuration
+    loop = newEventLoop();
+    loop->add(sock);
 }
 
 CNServer::CNServer() {};
 CNServer::CNServer(uint16_t p): port(p) {}
 
 void CNServer::addPollFD(SOCKET s) {
-    fds.push_back({s, POLLIN});
+    loop->add(s);
 }
 
-void CNServer::removePollFD(int i) {
-    auto it = fds.begin();
-    while (it != fds.end() && it->fd != fds[i].fd)
-        it++;
-    assert(it != fds.end());
-
-    fds.erase(it);
+void CNServer::removePollFD(SOCKET s) {
+    loop->remove(s);
 }
 
 void CNServer::start() {
-    std::cout << "Starting server at *:" << port << std::endl;
+    std::cout << "Starting server at *:" << port << " (" << loop->name() << ")" << std::endl;
+    std::vector<SocketEvent> events;
+    std::vector<SOCKET> backlog;
+
     while (active) {
-        // the timeout is to ensure shard timers are ticking
-        int n = poll(fds.data(), fds.size(), 50);
+        // the timeout is to ensure shard timers are ticking; sockets we still owe a read don't wait at all
+        int n = loop->wait(events, stillReadable.empty() ? pollTimeout() : 0);
         if (SOCKETERROR(n)) {
 #ifndef _WIN32
             if (errno == EINTR)
@@ -395,79 +519,158 @@ void CNServer::start() {
             terminate(0);
         }
 
-        for (int i = 0; i < fds.size() && n > 0; i++) {
-            if (fds[i].revents == 0)
-                continue; // nothing in this one; don't decrement n
-
-            n--;
+        backlog.swap(stillReadable);
 
+        for (SocketEvent& ev : events) {
             // is it the listener?
-            if (fds[i].fd == sock) {
+            if (ev.fd == sock) {
                 // any sort of error on the listener
-                if (fds[i].revents & ~POLLIN) {
+                if (ev.revents & ~POLLIN) {
                     std::cout << "[FATAL] Error on listener socket" << std::endl;
                     terminate(0);
                 }
 
-                SOCKET newConnectionSocket = accept(sock, (struct sockaddr *)&address, (socklen_t*)&addressSize);
-                if (SOCKETINVALID(newConnectionSocket)) {
-                    printSocketError("accept");
-                    continue;
-                }
+                // accept everything that's pending, since edge-triggered backends won't tell us again
+                for (;;) {
+                    SOCKET newConnectionSocket = accept(sock, (struct sockaddr *)&address, (socklen_t*)&addressSize);
+                    if (SOCKETINVALID(newConnectionSocket)) {
+                        if (OF_ERRNO != OF_EWOULD)
+                            printSocketError("accept");
+                        break;
+                    }
 
-                if (!setSockNonblocking(sock, newConnectionSocket))
-                    continue;
+                    if (!setSockNonblocking(sock, newConnectionSocket))
+                        continue;
 
-                std::cout << "New connection! " << inet_ntoa(address.sin_addr) << std::endl;
+                    std::cout << "New connection! " << inet_ntoa(address.sin_addr) << std::endl;
 
-                addPollFD(newConnectionSocket);
+                    addPollFD(newConnectionSocket);
 
-                // add connection to list!
-                CNSocket* tmp = new CNSocket(newConnectionSocket, address, pHandler);
-                connections[newConnectionSocket] = tmp;
-                newConnection(tmp);
+                    // add connection to list!
+                    CNSocket* tmp = new CNSocket(newConnectionSocket, address, pHandler, &flushQueue);
+                    connections[newConnectionSocket] = tmp;
+                    newConnection(tmp);
+                }
 
-            } else if (checkExtraSockets(i)) {
+            } else if (checkExtraSockets(ev.fd, ev.revents)) {
                 // no-op. handled in checkExtraSockets().
 
             } else {
                 std::lock_guard<std::mutex> lock(activeCrit); // protect operations on connections
 
                 // player sockets
-                if (connections.find(fds[i].fd) == connections.end()) {
+                auto it = connections.find(ev.fd);
+                if (it == connections.end()) {
                     std::cout << "[WARN] Event on non-existant socket?" << std::endl;
                     continue; // just to be safe
                 }
 
-                CNSocket* cSock = connections[fds[i].fd];
+                CNSocket* cSock = it->second;
 
                 // kill the socket on hangup/error
-                if (fds[i].revents & ~POLLIN)
+                if (ev.revents & ~(POLLIN | POLLOUT))
                     cSock->kill();
 
-                if (cSock->isAlive()) {
-                    cSock->step();
-                } else {
-                    killConnection(cSock);
-                    connections.erase(fds[i].fd);
-                    delete cSock;
+                // the kernel has room for the rest of our queued data
+                if (cSock->isAlive() && (ev.revents & POLLOUT) && cSock->flush()) {
+                    cSock->awaitingWritable = false;
+                    loop->setWritable(ev.fd, false);
+                }
 
-                    removePollFD(i);
+                if (cSock->isAlive() && (ev.revents & POLLIN))
+                    readSocket(cSock);
 
-                    // a new entry was moved to this position, so we check it again
-                    i--;
-                }
+                if (!cSock->isAlive())
+                    removeConnection(cSock);
             }
         }
 
+        readBacklog(backlog);
+
         onStep();
+        flushSockets();
     }
 }
 
+/*
+ * Edge-triggered backends only report a socket once per batch of new data, so it has to be read
+ * until it would block. That's capped per loop iteration so a client that keeps its socket full
+ * can't hold up everyone else; whatever's left is picked up by readBacklog() next time around.
+ */
+void CNServer::readSocket(CNSocket* cSock) {
+    if (!loop->edgeTriggered()) {
+        cSock->step();
+        return;
+    }
+
+    for (int i = 0; i < MAXREADSPERWAKEUP; i++) {
+        if (!cSock->step())
+            return;
+    }
+
+    stillReadable.push_back(cSock->sock);
+}
+
+// reads from the sockets that hit the cap last iteration, unless they're gone by now
+void CNServer::readBacklog(std::vector<SOCKET>& backlog) {
+    std::lock_guard<std::mutex> lock(activeCrit); // protect operations on connections
+
+    for (SOCKET fd : backlog) {
+        auto it = connections.find(fd);
+        if (it == connections.end())
+            continue;
+
+        CNSocket* cSock = it->second;
+        if (cSock->isAlive())
+            readSocket(cSock);
+
+        if (!cSock->isAlive())
+            removeConnection(cSock);
+    }
+
+    backlog.clear();
+}
+
+// forgets about a connection that's been killed; cSock is deleted
+void CNServer::removeConnection(CNSocket* cSock) {
+    SOCKET fd = cSock->sock;
+
+    killConnection(cSock);
+    connections.erase(fd);
+    removePollFD(fd);
+
+    if (cSock->isFlushQueued())
+        flushQueue.erase(std::remove(flushQueue.begin(), flushQueue.end(), cSock), flushQueue.end());
+
+    delete cSock;
+}
+
+/*
+ * Sends everything that was queued up during this loop iteration.
+ * Sockets the kernel can't keep up with are left buffered until they're writable.
+ */
+void CNServer::flushSockets() {
+    std::lock_guard<std::mutex> lock(activeCrit); // protect operations on connections
+
+    for (CNSocket* cSock : flushQueue) {
+        bool drained = cSock->flush();
+
+        if (cSock->isAlive() && drained == cSock->awaitingWritable) {
+            cSock->awaitingWritable = !drained;
+            loop->setWritable(cSock->sock, !drained);
+        }
+    }
+
+    flushQueue.clear();
+}
+
 void CNServer::kill() {
     std::lock_guard<std::mutex> lock(activeCrit); // the lock will be removed when the function ends
     active = false;
 
+    flushQueue.clear();
+    stillReadable.clear();
+
     // kill all connections
     for (auto& pair : connections) {
         CNSocket *cSock = pair.second;
@@ -502,7 +705,8 @@ void CNServer::printPacket(CNPacketData *data, int type) {
     std::cout << "OpenFusion: received " << Packets::p2str(type, data->type) << " (" << data->type << ")" << std::endl;
 }
 
-bool CNServer::checkExtraSockets(int i) { return false; } // stubbed
+bool CNServer::checkExtraSockets(SOCKET fd, int revents) { return false; } // stubbed
 void CNServer::newConnection(CNSocket* cns) {} // stubbed
 void CNServer::killConnection(CNSocket* cns) {} // stubbed
 void CNServer::onStep() {} // stubbed
+int CNServer::pollTimeout() { return 50; }
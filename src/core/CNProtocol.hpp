@@ -27,6 +27,7 @@
 #else
 // posix platform
     #include <sys/socket.h>
+    #include <sys/uio.h>
     #include <netinet/in.h>
     #include <arpa/inet.h>
     #include <poll.h>
@@ -148,30 +149,85 @@ enum ACTIVEKEY {
     SOCKETKEY_FE
 };
 
+/*
+ * Growable ring buffer for outbound data that hasn't made it into the kernel yet.
+ * Capacity is always a power of two. At most two contiguous spans are ever
+ * readable, so the whole thing can be flushed with a single writev().
+ */
+class CNRingBuffer {
+private:
+    uint8_t* data = nullptr;
+    size_t capacity = 0;
+    size_t head = 0; // index of the first unsent byte
+    size_t used = 0;
+
+    void grow(size_t needed);
+
+public:
+    ~CNRingBuffer();
+
+    void push(uint8_t* buf, size_t len);
+    void pop(size_t len);
+    // returns the number of spans (0-2) that make up the buffered data
+    int spans(uint8_t** ptrs, size_t* lens);
+    size_t size() { return used; }
+};
+
+/*
+ * A packet that's going out to many sockets at once (ex. everyone who can see an NPC).
+ * The checksum and plaintext frame are only built once, on first use, and the
+ * ciphertext is reused for consecutive recipients that share the same key.
+ */
+class CNBroadcastPacket {
+private:
+    void* buf;
+    uint32_t type;
+    size_t size;
+
+    uint8_t plainFrame[CN_PACKET_BUFFER_SIZE]; // length, type, body
+    uint8_t cipherFrame[CN_PACKET_BUFFER_SIZE];
+    size_t frameSize = 0; // 0 until the frame is built
+    uint64_t cipherKey = 0;
+    bool encrypted = false;
+
+public:
+    CNBroadcastPacket(void* b, uint32_t t, size_t l);
+
+    uint8_t* encrypt(uint64_t key);
+    size_t getFrameSize() { return frameSize; }
+};
+
 class CNSocket;
+class EventLoop;
 typedef void (*PacketHandler)(CNSocket* sock, CNPacketData* data);
 
 class CNSocket {
 private:
     uint64_t EKey;
     uint64_t FEKey;
-    int32_t readSize = 0;
-    uint8_t readBuffer[CN_PACKET_BUFFER_SIZE];
-    int readBufferIndex = 0;
-    bool activelyReading = false;
+    // holds several packets at once, so a burst can be read in a single recv()
+    alignas(4) uint8_t readBuffer[CN_PACKET_BUFFER_SIZE * 4];
+    int readBufferIndex = 0; // number of buffered bytes
     bool alive = true;
 
     ACTIVEKEY activeKey;
 
-    bool sendData(uint8_t* data, int size);
+    CNRingBuffer sendBuffer;
+    std::vector<CNSocket*>* flushQueue; // owned by the server; nullptr means flush immediately
+    bool flushQueued = false;
+    time_t congestedSince = 0; // when the send buffer went over the high-water mark
+
     int recvData(buffer_t* data, int size);
+    void queueData(uint8_t* data, size_t size);
 
 public:
     SOCKET sock;
     sockaddr_in sockaddr;
     PacketHandler pHandler;
+    bool awaitingWritable = false; // managed by the server; set while we wait for POLLOUT
 
-    CNSocket(SOCKET s, struct sockaddr_in &addr, PacketHandler ph);
+    CNSocket(SOCKET s, struct sockaddr_in &addr, PacketHandler ph, std::vector<CNSocket*>* fq=nullptr);
+    ~CNSocket();
 
     void setEKey(uint64_t k);
     void setFEKey(uint64_t k);
@@ -181,8 +237,11 @@ public:
 
     void kill();
     void sendPacket(void* buf, uint32_t packetType, size_t size);
-    void step();
+    void sendPacket(CNBroadcastPacket& pkt);
+    bool flush();
+    bool step();
     bool isAlive();
+    bool isFlushQueued();
 };
 
 class CNServer;
@@ -202,11 +261,14 @@ struct TimerEvent {
 // in charge of accepting new connections and making sure each connection is kept alive
 class CNServer {
 protected:
+    static const int MAXREADSPERWAKEUP = 8; // full read buffers taken from one socket per loop iteration
+
     std::unordered_map<SOCKET, CNSocket*> connections;
     std::mutex activeCrit;
 
-    const size_t STARTFDSCOUNT = 8; // number of initial PollFD slots
-    std::vector<PollFD> fds;
+    EventLoop* loop;
+    std::vector<CNSocket*> flushQueue; // sockets with outbound data buffered this iteration
+    std::vector<SOCKET> stillReadable; // sockets that hit the read cap and have to be read again next iteration
 
     SOCKET sock;
     uint16_t port;
@@ -223,13 +285,19 @@ public:
     CNServer(uint16_t p);
 
     void addPollFD(SOCKET s);
-    void removePollFD(int i);
+    void removePollFD(SOCKET s);
+    void flushSockets();
+    void readSocket(CNSocket* cSock);
+    void readBacklog(std::vector<SOCKET>& backlog);
+    void removeConnection(CNSocket* cSock);
 
     void start();
     void kill();
     static void printPacket(CNPacketData *data, int type);
-    virtual bool checkExtraSockets(int i);
+    virtual bool checkExtraSockets(SOCKET fd, int revents);
     virtual void newConnection(CNSocket* cns);
     virtual void killConnection(CNSocket* cns);
     virtual void onStep();
+    // how long start() may block waiting for sockets before onStep() has to run again, in ms
+    virtual int pollTimeout();
 };
@@ -14,6 +14,12 @@ void CNSharedData::setPlayer(int64_t sk, Player& plr) {
     players[sk] = plr;
 }
 
+bool CNSharedData::hasPlayer(int64_t sk) {
+    std::lock_guard<std::mutex> lock(playerCrit); // the lock will be removed when the function ends
+
+    return players.find(sk) != players.end();
+}
+
 Player CNSharedData::getPlayer(int64_t sk) {
     std::lock_guard<std::mutex> lock(playerCrit); // the lock will be removed when the function ends
 
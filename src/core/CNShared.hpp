@@ -15,6 +15,7 @@ namespace CNSharedData {
     extern std::map<int64_t, Player> players;
 
     void setPlayer(int64_t sk, Player& plr);
+    bool hasPlayer(int64_t sk);
     Player getPlayer(int64_t sk);
     void erasePlayer(int64_t sk);
 }
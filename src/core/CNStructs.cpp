@@ -0,0 +1,66 @@
+#include "core/CNStructs.hpp"
+
+#include <chrono>
+
+// helper functions, kept out of main.cpp so the checks can link the rest of the server without it
+
+std::string U16toU8(char16_t* src, size_t max) {
+    src[max-1] = '\0'; // force a NULL terminatorstd::string U16toU8(char16_t* src) {
+    try {
+        std::wstring_convert<std::codecvt_utf8_utf16<char16_t>,char16_t> convert;
+        return convert.to_bytes(src);
+    } catch(const std::exception& e) {
+        return "";
+    }
+}
+
+// returns number of char16_t that was written at des
+size_t U8toU16(std::string src, char16_t* des, size_t max) {
+    std::wstring_convert<std::codecvt_utf8_utf16<char16_t>,char16_t> convert;
+    std::u16string tmp = convert.from_bytes(src);
+
+    // copy utf16 string to buffer
+    if (sizeof(char16_t) * tmp.length() > max) // make sure we don't write outside the buffer
+        memcpy(des, tmp.c_str(), sizeof(char16_t) * max);
+    else
+        memcpy(des, tmp.c_str(), sizeof(char16_t) * tmp.length());
+    des[tmp.length()] = '\0';
+
+    return tmp.length();
+}
+
+time_t getTime() {
+    using namespace std::chrono;
+
+    milliseconds value = duration_cast<milliseconds>((time_point_cast<milliseconds>(high_resolution_clock::now())).time_since_epoch());
+
+    return (time_t)value.count();
+}
+
+// returns system time in seconds
+time_t getTimestamp() {
+    using namespace std::chrono;
+
+    seconds value = duration_cast<seconds>((time_point_cast<seconds>(system_clock::now())).time_since_epoch());
+
+    return (time_t)value.count();
+}
+
+// convert integer timestamp (in s) to FF systime struct
+sSYSTEMTIME timeStampToStruct(uint64_t time) {
+
+    const time_t timeProper = time;
+    tm ts = *localtime(&timeProper);
+
+    sSYSTEMTIME systime;
+    systime.wMilliseconds = 0;
+    systime.wSecond = ts.tm_sec;
+    systime.wMinute = ts.tm_min;
+    systime.wHour = ts.tm_hour;
+    systime.wDay = ts.tm_mday;
+    systime.wDayOfWeek = ts.tm_wday + 1;
+    systime.wMonth = ts.tm_mon + 1;
+    systime.wYear = ts.tm_year + 1900;
+
+    return systime;
+}
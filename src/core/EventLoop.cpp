@@ -0,0 +1,129 @@
+#include "core/EventLoop.hpp"
+
+#include <assert.h>
+
+// ========================================================[[ PollEventLoop ]]========================================================
+
+void PollEventLoop::add(SOCKET fd) {
+    indices[fd] = fds.size();
+    fds.push_back({fd, POLLIN});
+}
+
+void PollEventLoop::remove(SOCKET fd) {
+    auto it = indices.find(fd);
+    assert(it != indices.end());
+
+    // swap the last entry into the freed slot
+    size_t i = it->second;
+    fds[i] = fds.back();
+    indices[fds[i].fd] = i;
+
+    fds.pop_back();
+    indices.erase(fd);
+}
+
+void PollEventLoop::setWritable(SOCKET fd, bool writable) {
+    auto it = indices.find(fd);
+    assert(it != indices.end());
+
+    fds[it->second].events = writable ? (POLLIN | POLLOUT) : POLLIN;
+}
+
+int PollEventLoop::wait(std::vector<SocketEvent>& out, int timeout) {
+    out.clear();
+
+    int n = poll(fds.data(), fds.size(), timeout);
+    if (SOCKETERROR(n))
+        return n;
+
+    for (size_t i = 0; i < fds.size() && out.size() < (size_t)n; i++) {
+        if (fds[i].revents == 0)
+            continue;
+
+        out.push_back({fds[i].fd, fds[i].revents});
+    }
+
+    return out.size();
+}
+
+// ========================================================[[ EpollEventLoop ]]========================================================
+
+#ifdef __linux__
+EpollEventLoop::EpollEventLoop() {
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        printSocketError("epoll_create1");
+        std::cerr << "[FATAL] OpenFusion: epoll_create1 failed" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+EpollEventLoop::~EpollEventLoop() {
+    close(epfd);
+}
+
+void EpollEventLoop::add(SOCKET fd) {
+    epoll_event ev = {};
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.fd = fd;
+
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0)
+        printSocketError("epoll_ctl");
+}
+
+void EpollEventLoop::remove(SOCKET fd) {
+    // the event argument is ignored, but old kernels require it to be non-null
+    epoll_event ev = {};
+
+    if (epoll_ctl(epfd, EPOLL_CTL_DEL, fd, &ev) < 0)
+        printSocketError("epoll_ctl");
+}
+
+void EpollEventLoop::setWritable(SOCKET fd, bool writable) {
+    epoll_event ev = {};
+    ev.events = EPOLLIN | EPOLLET;
+    if (writable)
+        ev.events |= EPOLLOUT;
+    ev.data.fd = fd;
+
+    if (epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev) < 0)
+        printSocketError("epoll_ctl");
+}
+
+int EpollEventLoop::wait(std::vector<SocketEvent>& out, int timeout) {
+    out.clear();
+
+    int n = epoll_wait(epfd, events, MAXEVENTS, timeout);
+    if (n < 0)
+        return n;
+
+    for (int i = 0; i < n; i++) {
+        int revents = 0;
+
+        if (events[i].events & EPOLLIN)
+            revents |= POLLIN;
+        if (events[i].events & EPOLLOUT)
+            revents |= POLLOUT;
+        if (events[i].events & EPOLLERR)
+            revents |= POLLERR;
+        if (events[i].events & EPOLLHUP)
+            revents |= POLLHUP;
+
+        out.push_back({events[i].data.fd, revents});
+    }
+
+    return n;
+}
+#endif
+
+EventLoop* newEventLoop() {
+#ifdef __linux__
+    if (settings::EVENTLOOP == "epoll")
+        return new EpollEventLoop();
+#endif
+
+    if (settings::EVENTLOOP != "poll")
+        std::cout << "[WARN] Event loop backend " << settings::EVENTLOOP << " is unavailable, falling back to poll" << std::endl;
+
+    return new PollEventLoop();
+}
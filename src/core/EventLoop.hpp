@@ -0,0 +1,76 @@
+#pragma once
+
+#include "core/CNProtocol.hpp"
+
+#ifdef __linux__
+    #include <sys/epoll.h>
+#endif
+
+/*
+ * Socket readiness backends for CNServer.
+ *
+ * Events are always reported using poll() flags (POLLIN, POLLHUP, etc.) regardless
+ * of the backend, so the server loop doesn't need to care which one it's using.
+ * Edge-triggered backends only report a socket again once new data arrives, so
+ * anything that's readable must be drained until it would block.
+ */
+
+struct SocketEvent {
+    SOCKET fd;
+    int revents;
+};
+
+class EventLoop {
+public:
+    virtual ~EventLoop() {}
+
+    virtual void add(SOCKET fd) = 0;
+    virtual void remove(SOCKET fd) = 0;
+    // also report POLLOUT for this socket while writable is set
+    virtual void setWritable(SOCKET fd, bool writable) = 0;
+
+    // fills out with the sockets that are ready; returns the count or -1 on error
+    virtual int wait(std::vector<SocketEvent>& out, int timeout) = 0;
+
+    virtual bool edgeTriggered() = 0;
+    virtual const char* name() = 0;
+};
+
+// portable fallback; scans every registered socket on each wakeup
+class PollEventLoop : public EventLoop {
+private:
+    std::vector<PollFD> fds;
+    std::unordered_map<SOCKET, size_t> indices; // socket -> index into fds
+
+public:
+    void add(SOCKET fd);
+    void remove(SOCKET fd);
+    void setWritable(SOCKET fd, bool writable);
+    int wait(std::vector<SocketEvent>& out, int timeout);
+    bool edgeTriggered() { return false; }
+    const char* name() { return "poll"; }
+};
+
+#ifdef __linux__
+class EpollEventLoop : public EventLoop {
+private:
+    static const int MAXEVENTS = 256; // ready sockets returned per wakeup; the rest are picked up next time
+
+    int epfd;
+    epoll_event events[MAXEVENTS];
+
+public:
+    EpollEventLoop();
+    ~EpollEventLoop();
+
+    void add(SOCKET fd);
+    void remove(SOCKET fd);
+    void setWritable(SOCKET fd, bool writable);
+    int wait(std::vector<SocketEvent>& out, int timeout);
+    bool edgeTriggered() { return true; }
+    const char* name() { return "epoll"; }
+};
+#endif
+
+// picks a backend according to settings::EVENTLOOP, falling back to poll() where needed
+EventLoop* newEventLoop();
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/*
+ * Generational handles.
+ *
+ * A handle is a slot index plus the generation that slot was on when the handle was given out.
+ * Removing an entry bumps its slot's generation, so old handles stop resolving instead of pointing at
+ * whoever gets the slot (or the same address) next. That makes them safe to hold on to across ticks,
+ * where a raw pointer would need a players.find() before every use, and resolving one is a single
+ * array access.
+ */
+struct EntityHandle {
+    uint32_t index = 0;
+    uint32_t generation = 0; // never handed out, so a default-constructed handle is always empty
+
+    bool isNull() const { return generation == 0; }
+
+    bool operator==(const EntityHandle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const EntityHandle& other) const {
+        return !(*this == other);
+    }
+};
+
+namespace std {
+    template<>
+    struct hash<EntityHandle> {
+        size_t operator()(const EntityHandle& handle) const {
+            return std::hash<uint64_t>()(((uint64_t)handle.generation << 32) | handle.index);
+        }
+    };
+}
+
+template<typename T>
+class HandleTable {
+private:
+    struct Slot {
+        T* ptr = nullptr;
+        uint32_t generation = 1;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    size_t live = 0;
+
+public:
+    EntityHandle add(T* ptr) {
+        uint32_t index;
+        if (!freeSlots.empty()) {
+            index = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            index = slots.size();
+            slots.emplace_back();
+        }
+
+        slots[index].ptr = ptr;
+        live++;
+        return {index, slots[index].generation};
+    }
+
+    // stale or empty handles are ignored
+    void remove(EntityHandle handle) {
+        if (get(handle) == nullptr)
+            return;
+
+        Slot& slot = slots[handle.index];
+        slot.ptr = nullptr;
+        if (++slot.generation == 0)
+            slot.generation = 1; // wrapped; skip the null generation
+        freeSlots.push_back(handle.index);
+        live--;
+    }
+
+    // nullptr if whatever the handle referred to has since been removed
+    T* get(EntityHandle handle) const {
+        if (handle.index >= slots.size() || slots[handle.index].generation != handle.generation)
+            return nullptr;
+
+        return slots[handle.index].ptr;
+    }
+
+    bool alive(EntityHandle handle) const {
+        return get(handle) != nullptr;
+    }
+
+    size_t size() const {
+        return live;
+    }
+};
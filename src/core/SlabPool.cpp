@@ -0,0 +1,79 @@
+#include "core/SlabPool.hpp"
+
+#include <algorithm>
+#include <new>
+
+static const size_t SLAB_BYTES = 64 * 1024; // aim for this much per slab...
+static const size_t MIN_SLOTS = 16; // ...but never fewer than this many slots
+
+static size_t roundSlot(size_t size) {
+    // every slot has to be able to hold a free list link, and stay aligned like operator new would
+    size_t align = alignof(std::max_align_t);
+    size = std::max(size, sizeof(void*));
+    return (size + align - 1) / align * align;
+}
+
+SlabPool::SlabPool(std::string n, size_t size)
+    : name(n), slotSize(roundSlot(size)), slotsPerSlab(std::max(MIN_SLOTS, SLAB_BYTES / roundSlot(size))) {
+    all().push_back(this);
+}
+
+std::vector<SlabPool*>& SlabPool::all() {
+    // function-local so pools in other translation units can register during static init
+    static std::vector<SlabPool*> pools;
+    return pools;
+}
+
+void SlabPool::grow() {
+    char* slab = (char*)::operator new(slotSize * slotsPerSlab);
+    slabs.push_back(slab);
+
+    // thread the new slots onto the free list back to front, so they get handed out in address order
+    for (size_t i = slotsPerSlab; i > 0; i--) {
+        FreeSlot* slot = (FreeSlot*)(slab + (i - 1) * slotSize);
+        slot->next = freeList;
+        freeList = slot;
+    }
+}
+
+void* SlabPool::alloc(size_t size) {
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (size > slotSize) {
+        oversized++;
+        return ::operator new(size);
+    }
+
+    if (freeList == nullptr)
+        grow();
+
+    FreeSlot* slot = freeList;
+    freeList = slot->next;
+
+    allocs++;
+    live++;
+    peak = std::max(peak, live);
+    return slot;
+}
+
+void SlabPool::free(void* p, size_t size) {
+    if (p == nullptr)
+        return;
+
+    if (size > slotSize) {
+        ::operator delete(p);
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    FreeSlot* slot = (FreeSlot*)p;
+    slot->next = freeList;
+    freeList = slot;
+    live--;
+}
+
+SlabPool::Stats SlabPool::stats() {
+    std::lock_guard<std::mutex> guard(lock);
+    return {live, peak, slabs.size(), slabs.size() * slotsPerSlab * slotSize, allocs, oversized};
+}
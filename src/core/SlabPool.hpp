@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__MINGW32__) && !defined(_GLIBCXX_HAS_GTHREADS)
+    #include "mingw/mingw.mutex.h"
+#else
+    #include <mutex>
+#endif
+
+/*
+ * Fixed-size object pool.
+ *
+ * Memory comes in slabs of several slots at a time, and freed slots go on an intrusive free list to
+ * be handed straight back out by the next alloc(). Objects never move, and slabs are never given back,
+ * so entities that come and go (chunks at borders, mobs in lairs) reuse the same few slabs instead of
+ * going through malloc every time.
+ *
+ * Classes opt in by defining their own operator new/delete in terms of a pool. Anything bigger than
+ * the slot size (a subclass that doesn't have its own pool) is passed on to the global allocator.
+ * Every pool registers itself so its stats can be looked at while the server's running, so pools are
+ * meant to be statics that live as long as the process does.
+ */
+class SlabPool {
+private:
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    std::mutex lock; // the DB writer thread allocates Players too
+    FreeSlot* freeList = nullptr;
+    std::vector<char*> slabs;
+
+    size_t live = 0;
+    size_t peak = 0;
+    uint64_t allocs = 0;
+    uint64_t oversized = 0;
+
+    void grow();
+
+public:
+    struct Stats {
+        size_t live; // objects currently handed out
+        size_t peak;
+        size_t slabs;
+        size_t bytes; // everything held in slabs, used or not
+        uint64_t allocs; // since startup
+        uint64_t oversized; // requests that went to the global allocator
+    };
+
+    const std::string name;
+    const size_t slotSize;
+    const size_t slotsPerSlab;
+
+    SlabPool(std::string name, size_t size);
+    SlabPool(const SlabPool&) = delete;
+    // intentionally leaks its slabs; something may still point into them during static destruction
+    ~SlabPool() {}
+
+    void* alloc(size_t size);
+    void free(void* p, size_t size);
+
+    Stats stats();
+
+    static std::vector<SlabPool*>& all();
+};
+
+// for types that can't carry their own operator new, like the standard containers
+template<typename T>
+class ObjectPool : public SlabPool {
+public:
+    ObjectPool(std::string name) : SlabPool(name, sizeof(T)) {}
+
+    template<typename... Args>
+    T* make(Args&&... args) {
+        return new (alloc(sizeof(T))) T(std::forward<Args>(args)...);
+    }
+
+    void destroy(T* p) {
+        if (p == nullptr)
+            return;
+
+        p->~T();
+        free(p, sizeof(T));
+    }
+};
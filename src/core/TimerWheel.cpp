@@ -0,0 +1,123 @@
+#include "core/TimerWheel.hpp"
+#include "core/CNStructs.hpp"
+
+#include <algorithm>
+
+uint64_t TimerWheel::schedule(time_t deadline, TimerCallback callback) {
+    if (cursor == -1)
+        cursor = getTime() / GRANULARITY;
+
+    // anything that's already overdue goes in the next slot to be processed
+    time_t tick = std::max(deadline / GRANULARITY, cursor);
+    size_t slot = tick & (SLOTS - 1);
+
+    uint64_t id = nextID++;
+    slots[slot].push_back({id, deadline, std::move(callback)});
+    slotOf[id] = slot;
+
+    if (earliestValid && (earliest == -1 || deadline < earliest))
+        earliest = deadline;
+
+    return id;
+}
+
+bool TimerWheel::cancel(uint64_t id) {
+    auto it = slotOf.find(id);
+    if (it == slotOf.end())
+        return false;
+
+    std::vector<Timer>& slot = slots[it->second];
+    for (size_t i = 0; i < slot.size(); i++) {
+        if (slot[i].id != id)
+            continue;
+
+        if (slot[i].deadline == earliest)
+            earliestValid = false;
+
+        slot[i] = std::move(slot.back());
+        slot.pop_back();
+        break;
+    }
+
+    slotOf.erase(it);
+    return true;
+}
+
+void TimerWheel::advance(time_t now) {
+    if (cursor == -1)
+        cursor = now / GRANULARITY;
+
+    time_t target = now / GRANULARITY;
+    if (target < cursor)
+        return;
+
+    // a whole lap visits every slot, so there's never a reason to go further than that
+    time_t count = std::min(target - cursor + 1, (time_t)SLOTS);
+    for (time_t i = 0; i < count; i++) {
+        std::vector<Timer>& slot = slots[(cursor + i) & (SLOTS - 1)];
+
+        for (size_t j = 0; j < slot.size();) {
+            if (slot[j].deadline > now) {
+                j++; // later in this tick, or a later lap
+                continue;
+            }
+
+            slotOf.erase(slot[j].id);
+            due.push_back(std::move(slot[j]));
+            slot[j] = std::move(slot.back());
+            slot.pop_back();
+        }
+    }
+
+    // the current tick isn't over yet, so it gets looked at again next time
+    cursor = target;
+
+    if (due.empty())
+        return;
+
+    earliestValid = false;
+
+    // fire in deadline order, falling back to scheduling order for ties
+    std::sort(due.begin(), due.end(), [](const Timer& a, const Timer& b) {
+        return a.deadline != b.deadline ? a.deadline < b.deadline : a.id < b.id;
+    });
+
+    for (Timer& timer : due)
+        timer.callback(now);
+    due.clear();
+}
+
+time_t TimerWheel::nextDeadline() {
+    if (earliestValid)
+        return earliest;
+
+    earliest = -1;
+    earliestValid = true;
+    if (slotOf.empty())
+        return earliest;
+
+    // walk forward from the cursor; the first slot holding something due this lap has the answer.
+    // overdue timers always sit in the cursor's slot, so they're caught by the first step
+    for (time_t tick = cursor; tick < cursor + SLOTS; tick++) {
+        for (Timer& timer : slots[tick & (SLOTS - 1)]) {
+            if (timer.deadline >= (tick + 1) * GRANULARITY)
+                continue; // a later lap
+
+            if (earliest == -1 || timer.deadline < earliest)
+                earliest = timer.deadline;
+        }
+
+        if (earliest != -1)
+            return earliest;
+    }
+
+    // everything's more than a lap out, which is rare enough to just look at it all
+    for (int i = 0; i < SLOTS; i++) {
+        for (Timer& timer : slots[i]) {
+            if (earliest == -1 || timer.deadline < earliest)
+                earliest = timer.deadline;
+        }
+    }
+
+    return earliest;
+}
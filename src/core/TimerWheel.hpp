@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+typedef std::function<void(time_t)> TimerCallback;
+
+/*
+ * Hashed timer wheel for one-off deadlines.
+ *
+ * Time is cut into GRANULARITY ms ticks and every timer sits in the slot for the tick it's due in,
+ * modulo SLOTS. Timers more than a lap out simply stay in their slot until their lap comes around.
+ * Scheduling and cancelling are O(1), and advancing only visits the slots that have elapsed since
+ * the last call, so nothing gets rescanned while it's still waiting. Finding the next deadline
+ * only walks forward to the first slot with something due in it.
+ *
+ * Callbacks are free to schedule or cancel other timers, including rescheduling themselves, but a
+ * timer that's due in the same advance() has already been pulled out and will fire regardless.
+ */
+class TimerWheel {
+private:
+    static const int SLOTS = 512; // must be a power of two
+    static const time_t GRANULARITY = 10; // ms per slot
+
+    struct Timer {
+        uint64_t id;
+        time_t deadline;
+        TimerCallback callback;
+    };
+
+    std::vector<Timer> slots[SLOTS];
+    std::unordered_map<uint64_t, size_t> slotOf; // timer id -> slot, for cancel()
+    std::vector<Timer> due; // reused between advance() calls
+
+    time_t cursor = -1; // first tick that hasn't been fully processed yet; -1 until first use
+    uint64_t nextID = 1;
+
+    time_t earliest = -1; // cached nextDeadline()
+    bool earliestValid = true;
+
+public:
+    // returns an id that can be passed to cancel()
+    uint64_t schedule(time_t deadline, TimerCallback callback);
+    // returns false if the timer already fired or never existed
+    bool cancel(uint64_t id);
+
+    // runs every callback whose deadline is at or before now
+    void advance(time_t now);
+
+    // the earliest pending deadline, or -1 if there's nothing scheduled
+    time_t nextDeadline();
+    size_t size() { return slotOf.size(); }
+};
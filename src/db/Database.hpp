@@ -44,9 +44,14 @@ namespace Database {
     void open();
     void close();
 
+    /// prints use counts and time spent per cached statement, slowest first
+    void printStatementStats();
+    /// prints how long each thread has waited for and held the DB locks
+    void printLockStats();
+
     void findAccount(Account* account, std::string login);
-    // returns ID, 0 if something failed
-    int addAccount(std::string login, std::string password);
+    // takes an already hashed password; returns ID, 0 if something failed
+    int addAccount(std::string login, std::string hashedPassword);
 
     // interface for the /ban command
     bool banPlayer(int playerId, std::string& reason);
@@ -78,7 +83,16 @@ namespace Database {
 
     // getting players
     void getPlayer(Player* plr, int id);
-    void updatePlayer(Player *player);
+    /// queues a copy of the player to be written by the DB thread; returns immediately.
+    /// final marks the last save of a session, so the DB thread can stop tracking them
+    void updatePlayer(Player *player, bool final=false);
+    /// blocks until every save queued so far has been written
+    void flushPlayers();
+    /// same, but only for saves of that one player, or of that account's players
+    void flushPlayer(int playerID);
+    void flushAccount(int accountID);
+    /// whether every save queued so far for that player has been written; doesn't block
+    bool isPlayerSaved(int playerID);
     
     // buddies
     int getNumBuddies(Player* player);
@@ -3,25 +3,24 @@
 // Email-related DB interactions
 
 int Database::getUnreadEmailCount(int playerID) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     const char* sql = R"(
         SELECT COUNT(*) FROM EmailData
         WHERE PlayerID = ? AND ReadFlag = 0;
         )";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, playerID);
     sqlite3_step(stmt);
     int ret = sqlite3_column_int(stmt, 0);
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     return ret;
 }
 
 std::vector<EmailData> Database::getEmails(int playerID, int page) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     std::vector<EmailData> emails;
 
@@ -36,8 +35,7 @@ std::vector<EmailData> Database::getEmails(int playerID, int page) {
         LIMIT 5
         OFFSET ?;
         )";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, playerID);
     int offset = 5 * page - 5;
     sqlite3_bind_int(stmt, 2, offset);
@@ -58,13 +56,13 @@ std::vector<EmailData> Database::getEmails(int playerID, int page) {
 
         emails.push_back(toAdd);
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     return emails;
 }
 
 EmailData Database::getEmail(int playerID, int index) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     const char* sql = R"(
         SELECT
@@ -74,15 +72,14 @@ EmailData Database::getEmail(int playerID, int index) {
         FROM EmailData
         WHERE PlayerID = ? AND MsgIndex = ?;
         )";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, playerID);
     sqlite3_bind_int(stmt, 2, index);
 
     EmailData result;
     if (sqlite3_step(stmt) != SQLITE_ROW) {
         std::cout << "[WARN] Database: Email not found!" << std::endl;
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return result;
     }
 
@@ -99,12 +96,12 @@ EmailData Database::getEmail(int playerID, int index) {
     result.SendTime = sqlite3_column_int64(stmt, 8);
     result.DeleteTime = sqlite3_column_int64(stmt, 9);
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return result;
 }
 
 sItemBase* Database::getEmailAttachments(int playerID, int index) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     sItemBase* items = new sItemBase[4];
     for (int i = 0; i < 4; i++)
@@ -115,8 +112,7 @@ sItemBase* Database::getEmailAttachments(int playerID, int index) {
         FROM EmailItems
         WHERE PlayerID = ? AND MsgIndex = ?;
         )";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, playerID);
     sqlite3_bind_int(stmt, 2, index);
 
@@ -133,20 +129,19 @@ sItemBase* Database::getEmailAttachments(int playerID, int index) {
         items[slot].iTimeLimit = sqlite3_column_int(stmt, 4);
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return items;
 }
 
 void Database::updateEmailContent(EmailData* data) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     const char* sql = R"(
         SELECT COUNT(*)
         FROM EmailItems
         WHERE PlayerID = ? AND MsgIndex = ?;
         )";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, data->PlayerId);
     sqlite3_bind_int(stmt, 2, data->MsgIndex);
     sqlite3_step(stmt);
@@ -154,7 +149,7 @@ void Database::updateEmailContent(EmailData* data) {
 
     data->ItemFlag = (data->Taros > 0 || attachmentsCount > 0) ? 1 : 0; // set attachment flag dynamically
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     sql = R"(
         UPDATE EmailData
@@ -173,7 +168,7 @@ void Database::updateEmailContent(EmailData* data) {
             DeleteTime = ?
         WHERE PlayerID = ? AND MsgIndex = ?;
         )";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, data->PlayerId);
     sqlite3_bind_int(stmt, 2, data->MsgIndex);
     sqlite3_bind_int(stmt, 3, data->ReadFlag);
@@ -192,11 +187,11 @@ void Database::updateEmailContent(EmailData* data) {
     if (sqlite3_step(stmt) != SQLITE_DONE)
         std::cout << "[WARN] Database: failed to update email: " << sqlite3_errmsg(db) << std::endl;
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 }
 
 void Database::deleteEmailAttachments(int playerID, int index, int slot) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     sqlite3_stmt* stmt;
 
@@ -209,7 +204,7 @@ void Database::deleteEmailAttachments(int playerID, int index, int slot) {
         sql += " AND \"Slot\" = ? ";
     sql += ";";
 
-    sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, NULL);
+    stmt = getStatement(sql.c_str());
     sqlite3_bind_int(stmt, 1, playerID);
     sqlite3_bind_int(stmt, 2, index);
     if (slot != -1)
@@ -217,11 +212,11 @@ void Database::deleteEmailAttachments(int playerID, int index, int slot) {
 
     if (sqlite3_step(stmt) != SQLITE_DONE)
         std::cout << "[WARN] Database: Failed to delete email attachments: " << sqlite3_errmsg(db) << std::endl;
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 }
 
 void Database::deleteEmails(int playerID, int64_t* indices) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     sqlite3_exec(db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
     sqlite3_stmt* stmt;
@@ -230,7 +225,7 @@ void Database::deleteEmails(int playerID, int64_t* indices) {
         DELETE FROM EmailData
         WHERE PlayerID = ? AND MsgIndex = ?;
         )";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    stmt = getStatement(sql);
 
     for (int i = 0; i < 5; i++) {
         sqlite3_bind_int(stmt, 1, playerID);
@@ -240,13 +235,13 @@ void Database::deleteEmails(int playerID, int64_t* indices) {
         }
         sqlite3_reset(stmt);
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     sqlite3_exec(db, "COMMIT;", NULL, NULL, NULL);
 }
 
 int Database::getNextEmailIndex(int playerID) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     const char* sql = R"(
         SELECT MsgIndex
@@ -255,18 +250,17 @@ int Database::getNextEmailIndex(int playerID) {
         ORDER BY MsgIndex DESC
         LIMIT 1;
         )";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, playerID);
     sqlite3_step(stmt);
     int index = sqlite3_column_int(stmt, 0);
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return (index > 0 ? index + 1 : 1);
 }
 
 bool Database::sendEmail(EmailData* data, std::vector<sItemBase> attachments) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     sqlite3_exec(db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
 
@@ -277,9 +271,7 @@ bool Database::sendEmail(EmailData* data, std::vector<sItemBase> attachments) {
             SubjectLine, MsgBody, Taros, SendTime, DeleteTime)
         VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
         )";
-    sqlite3_stmt* stmt;
-
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, data->PlayerId);
     sqlite3_bind_int(stmt, 2, data->MsgIndex);
     sqlite3_bind_int(stmt, 3, data->ReadFlag);
@@ -296,11 +288,11 @@ bool Database::sendEmail(EmailData* data, std::vector<sItemBase> attachments) {
     if (sqlite3_step(stmt) != SQLITE_DONE) {
         std::cout << "[WARN] Database: Failed to send email: " << sqlite3_errmsg(db) << std::endl;
         sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return false;
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     sql = R"(
         INSERT INTO EmailItems
@@ -308,7 +300,7 @@ bool Database::sendEmail(EmailData* data, std::vector<sItemBase> attachments) {
         VALUES (?, ?, ?, ?, ?, ?, ?);
         )";
 
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    stmt = getStatement(sql);
 
     // send attachments
     int slot = 1;
@@ -324,12 +316,12 @@ bool Database::sendEmail(EmailData* data, std::vector<sItemBase> attachments) {
         if (sqlite3_step(stmt) != SQLITE_DONE) {
             std::cout << "[WARN] Database: Failed to send email: " << sqlite3_errmsg(db) << std::endl;
             sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
-            sqlite3_finalize(stmt);
+            releaseStatement(stmt);
             return false;
         }
         sqlite3_reset(stmt);
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     sqlite3_exec(db, "COMMIT;", NULL, NULL, NULL);
     return true;
 }
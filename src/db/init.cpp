@@ -6,11 +6,35 @@
 #include <fstream>
 #include <sstream>
 
-std::mutex dbCrit;
+DBMutex dbCrit("db");
+DBMutex readCrit("readDb");
 sqlite3 *db;
+sqlite3 *readDb;
+
+DBLock::DBLock(DBMutex& m) : crit(m) {
+    auto start = std::chrono::steady_clock::now();
+    crit.mutex.lock();
+    acquired = std::chrono::steady_clock::now();
+
+    LockStats& stats = crit.stats[std::this_thread::get_id()];
+    stats.acquisitions++;
+    stats.waitTime += std::chrono::duration_cast<std::chrono::microseconds>(acquired - start).count();
+}
+
+DBLock::~DBLock() {
+    uint64_t held = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - acquired).count();
+
+    // still holding the lock, so the stats map is ours
+    LockStats& stats = crit.stats[std::this_thread::get_id()];
+    stats.holdTime += held;
+    if (held > stats.maxHold)
+        stats.maxHold = held;
+
+    crit.mutex.unlock();
+}
 
 static void createMetaTable() {
-    std::lock_guard<std::mutex> lock(dbCrit); // XXX
+    DBLock lock(dbCrit); // XXX
 
     sqlite3_exec(db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
 
@@ -20,27 +44,26 @@ static void createMetaTable() {
             Value INTEGER NOT NULL
         );
         )";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     if (sqlite3_step(stmt) != SQLITE_DONE) {
         std::cout << "[FATAL] Failed to create meta table: " << sqlite3_errmsg(db) << std::endl;
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
         exit(1);
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     sql = R"(
         INSERT INTO Meta (Key, Value)
         VALUES (?, ?);
         )";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    stmt = getStatement(sql);
     sqlite3_bind_text(stmt, 1, "ProtocolVersion", -1, NULL);
     sqlite3_bind_int(stmt, 2, PROTOCOL_VERSION);
 
     if (sqlite3_step(stmt) != SQLITE_DONE) {
         std::cout << "[FATAL] Failed to create meta table: " << sqlite3_errmsg(db) << std::endl;
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
         exit(1);
     }
@@ -49,7 +72,7 @@ static void createMetaTable() {
     sqlite3_bind_text(stmt, 1, "DatabaseVersion", -1, NULL);
     sqlite3_bind_int(stmt, 2, DATABASE_VERSION);
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     if (rc != SQLITE_DONE) {
         std::cout << "[FATAL] Failed to create meta table: " << sqlite3_errmsg(db) << std::endl;
         sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
@@ -65,68 +88,67 @@ static void checkMetaTable() {
     const char* sql = R"(
         SELECT COUNT(*) FROM sqlite_master WHERE type='table' AND name='Meta';
         )";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     if (sqlite3_step(stmt) != SQLITE_ROW) {
         std::cout << "[FATAL] Failed to check meta table" << sqlite3_errmsg(db) << std::endl;
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         exit(1);
     }
 
     int count = sqlite3_column_int(stmt, 0);
     if (count == 0) {
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         // check if there's other non-internal tables first
         sql = R"(
             SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND name NOT LIKE 'sqlite_%';
             )";
-        sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+        stmt = getStatement(sql);
         if (sqlite3_step(stmt) != SQLITE_ROW || sqlite3_column_int(stmt, 0) != 0) {
-            sqlite3_finalize(stmt);
+            releaseStatement(stmt);
             std::cout << "[FATAL] Existing DB is outdated" << std::endl;
             exit(1);
         }
 
         // create meta table
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return createMetaTable();
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     // check protocol version
     sql = R"(
         SELECT Value FROM Meta WHERE Key = 'ProtocolVersion';
         )";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    stmt = getStatement(sql);
 
     if (sqlite3_step(stmt) != SQLITE_ROW) {
         std::cout << "[FATAL] Failed to check DB Protocol Version: " << sqlite3_errmsg(db) << std::endl;
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         exit(1);
     }
 
     if (sqlite3_column_int(stmt, 0) != PROTOCOL_VERSION) {
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         std::cout << "[FATAL] DB Protocol Version doesn't match Server Build" << std::endl;
         exit(1);
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     sql = R"(
         SELECT Value FROM Meta WHERE Key = 'DatabaseVersion';
         )";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    stmt = getStatement(sql);
 
     if (sqlite3_step(stmt) != SQLITE_ROW) {
         std::cout << "[FATAL] Failed to check DB Version: " << sqlite3_errmsg(db) << std::endl;
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         exit(1);
     }
 
     int dbVersion = sqlite3_column_int(stmt, 0);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     if (dbVersion > DATABASE_VERSION) {
         std::cout << "[FATAL] Server Build is incompatible with DB Version" << std::endl;
@@ -189,15 +211,14 @@ static void createTables() {
 }
 
 static int getTableSize(std::string tableName) {
-    std::lock_guard<std::mutex> lock(dbCrit); // XXX
+    DBLock lock(dbCrit); // XXX
 
     const char* sql = "SELECT COUNT(*) FROM ?";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_text(stmt, 1, tableName.c_str(), -1, NULL);
     sqlite3_step(stmt);
     int result = sqlite3_column_int(stmt, 0);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return result;
 }
 
@@ -215,9 +236,28 @@ void Database::open() {
     // just in case a DB operation collides with an external manual modification
     sqlite3_busy_timeout(db, 2000);
 
+    // WAL lets readDb read while the shard is in the middle of a write.
+    // in WAL mode, synchronous=NORMAL can only lose the last few commits on power loss, never corrupt
+    sqlite3_stmt* stmt = getStatement("PRAGMA journal_mode=WAL;");
+    if (sqlite3_step(stmt) != SQLITE_ROW || std::string((const char*)sqlite3_column_text(stmt, 0)) != "wal")
+        std::cout << "[WARN] Database: Couldn't enable WAL; login lookups will wait on shard writes" << std::endl;
+    releaseStatement(stmt);
+    sqlite3_exec(db, "PRAGMA synchronous=NORMAL;", NULL, NULL, NULL);
+    sqlite3_exec(db, "PRAGMA cache_size=-16000;", NULL, NULL, NULL); // KiB
+
     checkMetaTable();
     createTables();
 
+    rc = sqlite3_open_v2(settings::DBPATH.c_str(), &readDb, SQLITE_OPEN_READONLY, NULL);
+    if (rc != SQLITE_OK) {
+        std::cout << "[FATAL] Cannot open database for reading: " << sqlite3_errmsg(readDb) << std::endl;
+        exit(1);
+    }
+    sqlite3_busy_timeout(readDb, 2000);
+    sqlite3_exec(readDb, "PRAGMA cache_size=-4000;", NULL, NULL, NULL);
+
+    startWriter();
+
     std::cout << "[INFO] Database in operation ";
     int accounts = getTableSize("Accounts");
     int players = getTableSize("Players");
@@ -236,5 +276,31 @@ void Database::open() {
 }
 
 void Database::close() {
+    stopWriter();
+
+    if (settings::VERBOSITY > 1) {
+        printStatementStats();
+        printLockStats();
+    }
+    finalizeStatements();
+
+    sqlite3_close(readDb);
     sqlite3_close(db);
 }
+
+static void printMutexStats(DBMutex& crit) {
+    DBLock lock(crit);
+
+    for (auto& pair : crit.stats) {
+        LockStats& stats = pair.second;
+        std::cout << "    " << crit.name << ", thread " << pair.first << ": " << stats.acquisitions << " locks, "
+            << stats.waitTime / 1000 << "ms waiting, " << stats.holdTime / 1000 << "ms held, "
+            << stats.maxHold / 1000 << "ms longest hold" << std::endl;
+    }
+}
+
+void Database::printLockStats() {
+    std::cout << "[INFO] Database: lock contention" << std::endl;
+    printMutexStats(dbCrit);
+    printMutexStats(readCrit);
+}
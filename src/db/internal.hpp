@@ -5,11 +5,60 @@
 
 #if defined(__MINGW32__) && !defined(_GLIBCXX_HAS_GTHREADS)
     #include "mingw/mingw.mutex.h"
+    #include "mingw/mingw.thread.h"
 #else
     #include <mutex>
+    #include <thread>
 #endif
 
-extern std::mutex dbCrit;
+#include <chrono>
+#include <map>
+
+// per-thread contention numbers for a DBMutex, in microseconds
+struct LockStats {
+    uint64_t acquisitions = 0;
+    uint64_t waitTime = 0;
+    uint64_t holdTime = 0;
+    uint64_t maxHold = 0;
+};
+
+struct DBMutex {
+    const char* name;
+    std::mutex mutex;
+    std::map<std::thread::id, LockStats> stats; // only touched while mutex is held
+
+    DBMutex(const char* n) : name(n) {}
+};
+
+// lock_guard for a DBMutex that records how long it waited for and held the lock
+class DBLock {
+private:
+    DBMutex& crit;
+    std::chrono::steady_clock::time_point acquired;
+
+public:
+    DBLock(DBMutex& m);
+    ~DBLock();
+};
+
+extern DBMutex dbCrit; // guards db
+extern DBMutex readCrit; // guards readDb
 extern sqlite3 *db;
+// read-only connection for login-side lookups; with WAL it doesn't have to wait for shard writes
+extern sqlite3 *readDb;
+
+// prepared statement cache; see statements.cpp.
+// use these in place of sqlite3_prepare_v2() and sqlite3_finalize()
+sqlite3_stmt* getStatement(const char* sql, sqlite3* conn=db);
+void releaseStatement(sqlite3_stmt* stmt);
+void finalizeStatements();
+
+// write-behind player saves; see writer.cpp
+// returns the number of rows written, or -1 on failure
+int savePlayer(Player *player, Player *last);
+namespace Database {
+    void startWriter();
+    void stopWriter(); // writes out anything still queued before returning
+}
 
 using namespace Database;
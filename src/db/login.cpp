@@ -1,9 +1,7 @@
 #include "db/internal.hpp"
 
-#include "bcrypt/BCrypt.hpp"
-
 void Database::findAccount(Account* account, std::string login) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(readCrit);
 
     const char* sql = R"(
         SELECT AccountID, Password, Selected, BannedUntil, BanReason
@@ -11,9 +9,7 @@ void Database::findAccount(Account* account, std::string login) {
         WHERE Login = ?
         LIMIT 1;
         )";
-    sqlite3_stmt* stmt;
-
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql, readDb);
     sqlite3_bind_text(stmt, 1, login.c_str(), -1, NULL);
 
     int rc = sqlite3_step(stmt);
@@ -24,26 +20,23 @@ void Database::findAccount(Account* account, std::string login) {
         account->BannedUntil = sqlite3_column_int64(stmt, 3);
         account->BanReason = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 }
 
-int Database::addAccount(std::string login, std::string password) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+int Database::addAccount(std::string login, std::string hashedPassword) {
+    DBLock lock(dbCrit);
 
     const char* sql = R"(
         INSERT INTO Accounts (Login, Password, AccountLevel)
         VALUES (?, ?, ?);
         )";
-    sqlite3_stmt* stmt;
-
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_text(stmt, 1, login.c_str(), -1, NULL);
-    std::string hashedPassword = BCrypt::generateHash(password);
     sqlite3_bind_text(stmt, 2, hashedPassword.c_str(), -1, NULL);
     sqlite3_bind_int(stmt, 3, settings::ACCLEVEL);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     if (rc != SQLITE_DONE) {
         std::cout << "[WARN] Database: failed to add new account" << std::endl;
         return 0;
@@ -53,7 +46,7 @@ int Database::addAccount(std::string login, std::string password) {
 }
 
 void Database::updateSelected(int accountId, int slot) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     if (slot < 1 || slot > 4) {
         std::cout << "[WARN] Invalid slot number passed to updateSelected()! " << std::endl;
@@ -67,20 +60,18 @@ void Database::updateSelected(int accountId, int slot) {
         WHERE AccountID = ?;
         )";
 
-    sqlite3_stmt* stmt;
-
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, slot);
     sqlite3_bind_int(stmt, 2, accountId);
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     if (rc != SQLITE_DONE)
         std::cout << "[WARN] Database fail on updateSelected(): " << sqlite3_errmsg(db) << std::endl;
 }
 
 bool Database::validateCharacter(int characterID, int userID) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(readCrit);
 
     // query whatever
     const char* sql = R"(
@@ -89,20 +80,18 @@ bool Database::validateCharacter(int characterID, int userID) {
         WHERE PlayerID = ? AND AccountID = ?
         LIMIT 1;
         )";
-    sqlite3_stmt* stmt;
-
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql, readDb);
     sqlite3_bind_int(stmt, 1, characterID);
     sqlite3_bind_int(stmt, 2, userID);
     int rc = sqlite3_step(stmt);
     // if we got a row back, the character is valid
     bool result = (rc == SQLITE_ROW);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return result;
 }
 
 bool Database::isNameFree(std::string firstName, std::string lastName) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(readCrit);
 
     const char* sql = R"(
         SELECT COUNT(*)
@@ -110,20 +99,18 @@ bool Database::isNameFree(std::string firstName, std::string lastName) {
         WHERE FirstName = ? AND LastName = ?
         LIMIT 1;
         )";
-    sqlite3_stmt* stmt;
-
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql, readDb);
     sqlite3_bind_text(stmt, 1, firstName.c_str(), -1, NULL);
     sqlite3_bind_text(stmt, 2, lastName.c_str(),  -1, NULL);
     int rc = sqlite3_step(stmt);
 
     bool result = (rc == SQLITE_ROW && sqlite3_column_int(stmt, 0) == 0);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return result;
 }
 
 bool Database::isSlotFree(int accountId, int slotNum) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(readCrit);
 
     if (slotNum < 1 || slotNum > 4) {
         std::cout << "[WARN] Invalid slot number passed to isSlotFree()! " << slotNum << std::endl;
@@ -136,20 +123,18 @@ bool Database::isSlotFree(int accountId, int slotNum) {
         WHERE AccountID = ? AND Slot = ?
         LIMIT 1;
         )";
-    sqlite3_stmt* stmt;
-
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql, readDb);
     sqlite3_bind_int(stmt, 1, accountId);
     sqlite3_bind_int(stmt, 2, slotNum);
     int rc = sqlite3_step(stmt);
 
     bool result = (rc == SQLITE_ROW && sqlite3_column_int(stmt, 0) == 0);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return result;
 }
 
 int Database::createCharacter(sP_CL2LS_REQ_SAVE_CHAR_NAME* save, int AccountID) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     sqlite3_exec(db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
 
@@ -164,7 +149,7 @@ int Database::createCharacter(sP_CL2LS_REQ_SAVE_CHAR_NAME* save, int AccountID)
     std::string firstName = AUTOU16TOU8(save->szFirstName);
     std::string lastName =  AUTOU16TOU8(save->szLastName);
 
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, AccountID);
     sqlite3_bind_int(stmt, 2, save->iSlotNum);
     sqlite3_bind_text(stmt, 3, firstName.c_str(), -1, NULL);
@@ -186,24 +171,24 @@ int Database::createCharacter(sP_CL2LS_REQ_SAVE_CHAR_NAME* save, int AccountID)
     sqlite3_bind_blob(stmt, 13, blobBuffer, sizeof(Player::iFirstUseFlag), NULL);
 
     if (sqlite3_step(stmt) != SQLITE_DONE) {
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
         return 0;
     }
 
     int playerId = sqlite3_last_insert_rowid(db);
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     sql = R"(
         INSERT INTO Appearances (PlayerID)
         VALUES (?);
         )";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, playerId);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     if (rc != SQLITE_DONE) {
         sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
         return 0;
@@ -214,7 +199,7 @@ int Database::createCharacter(sP_CL2LS_REQ_SAVE_CHAR_NAME* save, int AccountID)
 }
 
 bool Database::finishCharacter(sP_CL2LS_REQ_CHAR_CREATE* character, int accountId) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     sqlite3_exec(db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
 
@@ -223,19 +208,17 @@ bool Database::finishCharacter(sP_CL2LS_REQ_CHAR_CREATE* character, int accountI
         SET AppearanceFlag = 1
         WHERE PlayerID = ? AND AccountID = ? AND AppearanceFlag = 0;
         )";
-    sqlite3_stmt* stmt;
-
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, character->PCStyle.iPC_UID);
     sqlite3_bind_int(stmt, 2, accountId);
 
     if (sqlite3_step(stmt) != SQLITE_DONE) {
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
         return false;
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     sql = R"(
         UPDATE Appearances
@@ -250,7 +233,7 @@ bool Database::finishCharacter(sP_CL2LS_REQ_CHAR_CREATE* character, int accountI
             SkinColor = ?
         WHERE PlayerID = ?;
         )";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    stmt = getStatement(sql);
 
     sqlite3_bind_int(stmt, 1, character->PCStyle.iBody);
     sqlite3_bind_int(stmt, 2, character->PCStyle.iEyeColor);
@@ -263,18 +246,18 @@ bool Database::finishCharacter(sP_CL2LS_REQ_CHAR_CREATE* character, int accountI
     sqlite3_bind_int(stmt, 9, character->PCStyle.iPC_UID);
 
     if (sqlite3_step(stmt) != SQLITE_DONE) {
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
         return false;
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     sql = R"(
         INSERT INTO Inventory (PlayerID, Slot, ID, Type, Opt)
         VALUES (?, ?, ?, ?, 1);
         )";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, 0);
+    stmt = getStatement(sql);
 
     int items[3] = { character->sOn_Item.iEquipUBID, character->sOn_Item.iEquipLBID, character->sOn_Item.iEquipFootID };
     for (int i = 0; i < 3; i++) {
@@ -284,20 +267,20 @@ bool Database::finishCharacter(sP_CL2LS_REQ_CHAR_CREATE* character, int accountI
         sqlite3_bind_int(stmt, 4, i+1);
 
         if (sqlite3_step(stmt) != SQLITE_DONE) {
-            sqlite3_finalize(stmt);
+            releaseStatement(stmt);
             sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
             return false;
         }
         sqlite3_reset(stmt);
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     sqlite3_exec(db, "COMMIT;", NULL, NULL, NULL);
     return true;
 }
 
 bool Database::finishTutorial(int playerID, int accountID) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     sqlite3_exec(db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
 
@@ -308,8 +291,7 @@ bool Database::finishTutorial(int playerID, int accountID) {
             Quests = ?
         WHERE PlayerID = ? AND AccountID = ? AND TutorialFlag = 0;
         )";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
 
     unsigned char questBuffer[128] = { 0 };
 
@@ -327,12 +309,12 @@ bool Database::finishTutorial(int playerID, int accountID) {
     sqlite3_bind_int(stmt, 4, accountID);
 
     if (sqlite3_step(stmt) != SQLITE_DONE) {
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
         return false;
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
 #ifndef ACADEMY
     // Lightning Gun
@@ -341,17 +323,17 @@ bool Database::finishTutorial(int playerID, int accountID) {
             (PlayerID, Slot, ID, Type, Opt)
         VALUES (?, 0, 328, 0, 1);
         )";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    stmt = getStatement(sql);
 
     sqlite3_bind_int(stmt, 1, playerID);
 
     if (sqlite3_step(stmt) != SQLITE_DONE) {
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
         return false;
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     // Nano Buttercup
     sql = R"(
@@ -359,12 +341,12 @@ bool Database::finishTutorial(int playerID, int accountID) {
             (PlayerID, ID, Skill)
         VALUES (?, 1, 1);
         )";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    stmt = getStatement(sql);
 
     sqlite3_bind_int(stmt, 1, playerID);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     if (rc != SQLITE_DONE) {
         sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
@@ -377,7 +359,7 @@ bool Database::finishTutorial(int playerID, int accountID) {
 }
 
 int Database::deleteCharacter(int characterID, int userID) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     const char* sql = R"(
         SELECT Slot
@@ -386,28 +368,26 @@ int Database::deleteCharacter(int characterID, int userID) {
         LIMIT 1;
         )";
 
-    sqlite3_stmt* stmt;
-
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, userID);
     sqlite3_bind_int(stmt, 2, characterID);
     if (sqlite3_step(stmt) != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return 0;
     }
     int slot = sqlite3_column_int(stmt, 0);
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     sql = R"(
         DELETE FROM Players
         WHERE AccountID = ? AND PlayerID = ?;
         )";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, 0);
+    stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, userID);
     sqlite3_bind_int(stmt, 2, characterID);
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     if (rc != SQLITE_DONE)
         return 0;
@@ -416,7 +396,8 @@ int Database::deleteCharacter(int characterID, int userID) {
 }
 
 void Database::getCharInfo(std::vector <sP_LS2CL_REP_CHAR_INFO>* result, int userID) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    flushAccount(userID); // character select should reflect the last shard save (a separate shard process saves before letting go)
+    DBLock lock(readCrit);
 
     const char* sql = R"(
         SELECT
@@ -427,9 +408,7 @@ void Database::getCharInfo(std::vector <sP_LS2CL_REP_CHAR_INFO>* result, int use
         INNER JOIN Appearances as a ON p.PlayerID = a.PlayerID
         WHERE p.AccountID = ?;
         )";
-    sqlite3_stmt* stmt;
-
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql, readDb);
     sqlite3_bind_int(stmt, 1, userID);
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -466,9 +445,7 @@ void Database::getCharInfo(std::vector <sP_LS2CL_REP_CHAR_INFO>* result, int use
             FROM Inventory
             WHERE PlayerID = ? AND Slot < ?;
             )";
-        sqlite3_stmt* stmt2;
-
-        sqlite3_prepare_v2(db, sql2, -1, &stmt2, NULL);
+        sqlite3_stmt* stmt2 = getStatement(sql2, readDb);
         sqlite3_bind_int(stmt2, 1, toAdd.sPC_Style.iPC_UID);
         sqlite3_bind_int(stmt2, 2, AEQUIP_COUNT);
 
@@ -479,34 +456,33 @@ void Database::getCharInfo(std::vector <sP_LS2CL_REP_CHAR_INFO>* result, int use
             item->iOpt = sqlite3_column_int(stmt2, 3);
             item->iTimeLimit = sqlite3_column_int(stmt2, 4);
         }
-        sqlite3_finalize(stmt2);
+        releaseStatement(stmt2);
 
         result->push_back(toAdd);
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 }
 
 // NOTE: This is currently never called.
 void Database::evaluateCustomName(int characterID, CustomName decision) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     const char* sql = R"(
         UPDATE Players
         SET NameCheck = ?
         WHERE PlayerID = ?;
         )";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, int(decision));
     sqlite3_bind_int(stmt, 2, characterID);
 
     if (sqlite3_step(stmt) != SQLITE_DONE)
         std::cout << "[WARN] Database: Failed to update nameCheck: " << sqlite3_errmsg(db) << std::endl;
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 }
 
 bool Database::changeName(sP_CL2LS_REQ_CHANGE_CHAR_NAME* save, int accountId) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     const char* sql = R"(
         UPDATE Players
@@ -516,8 +492,7 @@ bool Database::changeName(sP_CL2LS_REQ_CHANGE_CHAR_NAME* save, int accountId) {
             NameCheck = ?
         WHERE PlayerID = ? AND AccountID = ?;
         )";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
 
     std::string firstName = AUTOU16TOU8(save->szFirstName);
     std::string lastName = AUTOU16TOU8(save->szLastName);
@@ -531,6 +506,6 @@ bool Database::changeName(sP_CL2LS_REQ_CHANGE_CHAR_NAME* save, int accountId) {
     sqlite3_bind_int(stmt, 5, accountId);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return rc == SQLITE_DONE;
 }
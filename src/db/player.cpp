@@ -37,7 +37,8 @@ static void removeExpiredVehicles(Player* player) {
 }
 
 void Database::getPlayer(Player* plr, int id) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    flushPlayer(id); // in case they're logging back in before their last save went through
+    DBLock lock(dbCrit);
 
     const char* sql = R"(
         SELECT
@@ -54,12 +55,10 @@ void Database::getPlayer(Player* plr, int id) {
         INNER JOIN Accounts as acc ON p.AccountID = acc.AccountID
         WHERE p.PlayerID = ?;
         )";
-    sqlite3_stmt* stmt;
-
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, id);
     if (sqlite3_step(stmt) != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         std::cout << "[WARN] Database: Failed to load character [" << id << "]: " << sqlite3_errmsg(db) << std::endl;
         return;
     }
@@ -120,7 +119,7 @@ void Database::getPlayer(Player* plr, int id) {
 
     plr->BankOwnership = sqlite3_column_int(stmt, 36);
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     // get inventory
     sql = R"(
@@ -129,7 +128,7 @@ void Database::getPlayer(Player* plr, int id) {
         WHERE PlayerID = ?;
         )";
 
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    stmt = getStatement(sql);
 
     sqlite3_bind_int(stmt, 1, id);
 
@@ -160,7 +159,7 @@ void Database::getPlayer(Player* plr, int id) {
         item->iTimeLimit = sqlite3_column_int(stmt, 4);
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     removeExpiredVehicles(plr);
 
@@ -171,7 +170,7 @@ void Database::getPlayer(Player* plr, int id) {
         WHERE PlayerID = ?;
         )";
 
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    stmt = getStatement(sql);
 
     sqlite3_bind_int(stmt, 1, id);
 
@@ -188,7 +187,7 @@ void Database::getPlayer(Player* plr, int id) {
         item->iOpt = sqlite3_column_int(stmt, 2);
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     // get nanos
     sql = R"(
@@ -197,7 +196,7 @@ void Database::getPlayer(Player* plr, int id) {
         WHERE PlayerID = ?;
         )";
 
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, id);
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -213,7 +212,7 @@ void Database::getPlayer(Player* plr, int id) {
         nano->iStamina = sqlite3_column_int(stmt, 2);
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     // get active quests
     sql = R"(
@@ -226,7 +225,7 @@ void Database::getPlayer(Player* plr, int id) {
         WHERE PlayerID = ?;
         )";
 
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, id);
 
     std::set<int> tasksSet; // used to prevent duplicate tasks from loading in
@@ -243,7 +242,7 @@ void Database::getPlayer(Player* plr, int id) {
         plr->RemainingNPCCount[i][2] = sqlite3_column_int(stmt, 3);
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     // get buddies
     sql = R"(
@@ -252,7 +251,7 @@ void Database::getPlayer(Player* plr, int id) {
         WHERE PlayerAID = ? OR PlayerBID = ?;
         )";
 
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, id);
     sqlite3_bind_int(stmt, 2, id);
 
@@ -266,7 +265,7 @@ void Database::getPlayer(Player* plr, int id) {
         i++;
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     // get blocked players
     sql = R"(
@@ -274,7 +273,7 @@ void Database::getPlayer(Player* plr, int id) {
         WHERE PlayerID = ?;
         )";
 
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, id);
 
     // i retains its value from after the loop over Buddyships
@@ -284,238 +283,303 @@ void Database::getPlayer(Player* plr, int id) {
         i++;
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 }
 
-void Database::updatePlayer(Player *player) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+// the save position; coordinates from inside lairs or on the monkey aren't worth keeping
+static void savedPosition(Player* player, int* pos) {
+    if (player->instanceID == 0 && !player->onMonkey) {
+        pos[0] = player->x;
+        pos[1] = player->y;
+        pos[2] = player->z;
+        pos[3] = player->angle;
+    } else {
+        pos[0] = player->lastX;
+        pos[1] = player->lastY;
+        pos[2] = player->lastZ;
+        pos[3] = player->lastAngle;
+    }
+}
 
-    sqlite3_exec(db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+// whether anything in the Players row itself needs updating
+static bool playerRowChanged(Player* player, Player* last) {
+    int pos[4], lastPos[4];
+    savedPosition(player, pos);
+    savedPosition(last, lastPos);
+
+    return player->level != last->level
+        || memcmp(player->equippedNanos, last->equippedNanos, sizeof(player->equippedNanos)) != 0
+        || memcmp(pos, lastPos, sizeof(pos)) != 0
+        || player->HP != last->HP
+        || player->fusionmatter != last->fusionmatter
+        || player->money != last->money
+        || memcmp(player->aQuestFlag, last->aQuestFlag, sizeof(player->aQuestFlag)) != 0
+        || player->batteryW != last->batteryW
+        || player->batteryN != last->batteryN
+        || player->iWarpLocationFlag != last->iWarpLocationFlag
+        || memcmp(player->aSkywayLocationFlag, last->aSkywayLocationFlag, sizeof(player->aSkywayLocationFlag)) != 0
+        || player->CurrentMissionID != last->CurrentMissionID
+        || player->PCStyle2.iPayzoneFlag != last->PCStyle2.iPayzoneFlag
+        || memcmp(player->iFirstUseFlag, last->iFirstUseFlag, sizeof(player->iFirstUseFlag)) != 0
+        || player->mentor != last->mentor
+        || player->BankOwnership != last->BankOwnership;
+}
 
-    const char* sql = R"(
-        UPDATE Players
-        SET
-            Level = ? , Nano1 = ?, Nano2 = ?, Nano3 = ?,
-            XCoordinate = ?, YCoordinate = ?, ZCoordinate = ?,
-            Angle = ?, HP = ?, FusionMatter = ?, Taros = ?, Quests = ?,
-            BatteryW = ?, BatteryN = ?, WarplocationFlag = ?,
-            SkywayLocationFlag = ?, CurrentMissionID = ?,
-            PayZoneFlag = ?, FirstUseFlag = ?, Mentor = ?, BankOwnership = ?
-        WHERE PlayerID = ?;
-        )";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    sqlite3_bind_int(stmt, 1, player->level);
-    sqlite3_bind_int(stmt, 2, player->equippedNanos[0]);
-    sqlite3_bind_int(stmt, 3, player->equippedNanos[1]);
-    sqlite3_bind_int(stmt, 4, player->equippedNanos[2]);
+// maps an Inventory table slot to equipment, inventory or bank, same as getPlayer()
+static sItemBase* itemSlot(Player* player, int slot) {
+    if (slot < AEQUIP_COUNT)
+        return &player->Equip[slot];
+    if (slot < AEQUIP_COUNT + AINVEN_COUNT)
+        return &player->Inven[slot - AEQUIP_COUNT];
+    return &player->Bank[slot - AEQUIP_COUNT - AINVEN_COUNT];
+}
 
-    if (player->instanceID == 0 && !player->onMonkey) {
-        sqlite3_bind_int(stmt, 5, player->x);
-        sqlite3_bind_int(stmt, 6, player->y);
-        sqlite3_bind_int(stmt, 7, player->z);
-        sqlite3_bind_int(stmt, 8, player->angle);
-    }
-    else {
-        sqlite3_bind_int(stmt, 5, player->lastX);
-        sqlite3_bind_int(stmt, 6, player->lastY);
-        sqlite3_bind_int(stmt, 7, player->lastZ);
-        sqlite3_bind_int(stmt, 8, player->lastAngle);
-    }
+// only compares what's actually stored
+static bool sameItem(sItemBase* a, sItemBase* b) {
+    return a->iType == b->iType && a->iID == b->iID && a->iOpt == b->iOpt && a->iTimeLimit == b->iTimeLimit;
+}
+
+static bool tasksChanged(Player* player, Player* last) {
+    return memcmp(player->tasks, last->tasks, sizeof(player->tasks)) != 0
+        || memcmp(player->RemainingNPCCount, last->RemainingNPCCount, sizeof(player->RemainingNPCCount)) != 0;
+}
 
-    sqlite3_bind_int(stmt, 9, player->HP);
-    sqlite3_bind_int(stmt, 10, player->fusionmatter);
-    sqlite3_bind_int(stmt, 11, player->money);
-    sqlite3_bind_blob(stmt, 12, player->aQuestFlag, sizeof(player->aQuestFlag), NULL);
-    sqlite3_bind_int(stmt, 13, player->batteryW);
-    sqlite3_bind_int(stmt, 14, player->batteryN);
-    sqlite3_bind_int(stmt, 15, player->iWarpLocationFlag);
-    sqlite3_bind_blob(stmt, 16, player->aSkywayLocationFlag, sizeof(player->aSkywayLocationFlag), NULL);
-    sqlite3_bind_int(stmt, 17, player->CurrentMissionID);
-    sqlite3_bind_int(stmt, 18, player->PCStyle2.iPayzoneFlag);
-    sqlite3_bind_blob(stmt, 19, player->iFirstUseFlag, sizeof(player->iFirstUseFlag), NULL);
-    sqlite3_bind_int(stmt, 20, player->mentor);
-    sqlite3_bind_int(stmt, 21, player->BankOwnership);
-    sqlite3_bind_int(stmt, 22, player->iID);
-
-    if (sqlite3_step(stmt) != SQLITE_DONE) {
+static bool stepStatement(sqlite3_stmt* stmt) {
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+
+    if (rc != SQLITE_DONE) {
         std::cout << "[WARN] Database: Failed to save player to database: " << sqlite3_errmsg(db) << std::endl;
-        sqlite3_finalize(stmt);
-        sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
-        return;
+        return false;
     }
+    return true;
+}
 
-    sqlite3_finalize(stmt);
+static bool deleteAll(const char* table, int playerId) {
+    std::string sql = std::string("DELETE FROM ") + table + " WHERE PlayerID = ?;";
+    sqlite3_stmt* stmt = getStatement(sql.c_str());
+    sqlite3_bind_int(stmt, 1, playerId);
+    bool ok = stepStatement(stmt);
+    releaseStatement(stmt);
+    return ok;
+}
 
-    // update inventory
-    sql = R"(
-        DELETE FROM Inventory WHERE PlayerID = ?;
-        )";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    sqlite3_bind_int(stmt, 1, player->iID);
-    int rc = sqlite3_step(stmt);
+/*
+ * The writer thread holds dbCrit and wraps this in a savepoint; see writer.cpp.
+ *
+ * last is what the writer thread wrote for this player the previous time around. Only rows that
+ * differ from it get written. Without it (first save of the session) every section is replaced
+ * outright, since what's in memory may already differ from what getPlayer() read.
+ */
+int savePlayer(Player *player, Player *last) {
+    int rows = 0;
+    sqlite3_stmt* stmt;
 
-    sqlite3_finalize(stmt);
+    if (last == nullptr || playerRowChanged(player, last)) {
+        const char* sql = R"(
+            UPDATE Players
+            SET
+                Level = ? , Nano1 = ?, Nano2 = ?, Nano3 = ?,
+                XCoordinate = ?, YCoordinate = ?, ZCoordinate = ?,
+                Angle = ?, HP = ?, FusionMatter = ?, Taros = ?, Quests = ?,
+                BatteryW = ?, BatteryN = ?, WarplocationFlag = ?,
+                SkywayLocationFlag = ?, CurrentMissionID = ?,
+                PayZoneFlag = ?, FirstUseFlag = ?, Mentor = ?, BankOwnership = ?
+            WHERE PlayerID = ?;
+            )";
+        stmt = getStatement(sql);
+        sqlite3_bind_int(stmt, 1, player->level);
+        sqlite3_bind_int(stmt, 2, player->equippedNanos[0]);
+        sqlite3_bind_int(stmt, 3, player->equippedNanos[1]);
+        sqlite3_bind_int(stmt, 4, player->equippedNanos[2]);
+
+        int pos[4];
+        savedPosition(player, pos);
+        sqlite3_bind_int(stmt, 5, pos[0]);
+        sqlite3_bind_int(stmt, 6, pos[1]);
+        sqlite3_bind_int(stmt, 7, pos[2]);
+        sqlite3_bind_int(stmt, 8, pos[3]);
+
+        sqlite3_bind_int(stmt, 9, player->HP);
+        sqlite3_bind_int(stmt, 10, player->fusionmatter);
+        sqlite3_bind_int(stmt, 11, player->money);
+        sqlite3_bind_blob(stmt, 12, player->aQuestFlag, sizeof(player->aQuestFlag), NULL);
+        sqlite3_bind_int(stmt, 13, player->batteryW);
+        sqlite3_bind_int(stmt, 14, player->batteryN);
+        sqlite3_bind_int(stmt, 15, player->iWarpLocationFlag);
+        sqlite3_bind_blob(stmt, 16, player->aSkywayLocationFlag, sizeof(player->aSkywayLocationFlag), NULL);
+        sqlite3_bind_int(stmt, 17, player->CurrentMissionID);
+        sqlite3_bind_int(stmt, 18, player->PCStyle2.iPayzoneFlag);
+        sqlite3_bind_blob(stmt, 19, player->iFirstUseFlag, sizeof(player->iFirstUseFlag), NULL);
+        sqlite3_bind_int(stmt, 20, player->mentor);
+        sqlite3_bind_int(stmt, 21, player->BankOwnership);
+        sqlite3_bind_int(stmt, 22, player->iID);
+
+        bool ok = stepStatement(stmt);
+        releaseStatement(stmt);
+        if (!ok)
+            return -1;
+        rows++;
+    }
 
-    sql = R"(
-        INSERT INTO Inventory
+    // update inventory; equipment, inventory and bank share one table
+    if (last == nullptr && !deleteAll("Inventory", player->iID))
+        return -1;
+
+    const char* sql = R"(
+        INSERT OR REPLACE INTO Inventory
             (PlayerID, Slot, Type, Opt, ID, Timelimit)
         VALUES (?, ?, ?, ?, ?, ?);
         )";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-
-    for (int i = 0; i < AEQUIP_COUNT; i++) {
-        if (player->Equip[i].iID == 0)
-            continue;
-
-        sqlite3_bind_int(stmt, 1, player->iID);
-        sqlite3_bind_int(stmt, 2, i);
-        sqlite3_bind_int(stmt, 3, player->Equip[i].iType);
-        sqlite3_bind_int(stmt, 4, player->Equip[i].iOpt);
-        sqlite3_bind_int(stmt, 5, player->Equip[i].iID);
-        sqlite3_bind_int(stmt, 6, player->Equip[i].iTimeLimit);
-
-        rc = sqlite3_step(stmt);
-
-        if (rc != SQLITE_DONE) {
-            std::cout << "[WARN] Database: Failed to save player to database: " << sqlite3_errmsg(db) << std::endl;
-            sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
-            sqlite3_finalize(stmt);
-            return;
-        }
-        sqlite3_reset(stmt);
-    }
-
-    for (int i = 0; i < AINVEN_COUNT; i++) {
-        if (player->Inven[i].iID == 0)
-            continue;
+    sqlite3_stmt* upsert = getStatement(sql);
 
-        sqlite3_bind_int(stmt, 1, player->iID);
-        sqlite3_bind_int(stmt, 2, i + AEQUIP_COUNT);
-        sqlite3_bind_int(stmt, 3, player->Inven[i].iType);
-        sqlite3_bind_int(stmt, 4, player->Inven[i].iOpt);
-        sqlite3_bind_int(stmt, 5, player->Inven[i].iID);
-        sqlite3_bind_int(stmt, 6, player->Inven[i].iTimeLimit);
-
-        if (sqlite3_step(stmt) != SQLITE_DONE) {
-            std::cout << "[WARN] Database: Failed to save player to database: " << sqlite3_errmsg(db) << std::endl;
-            sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
-            sqlite3_finalize(stmt);
-            return;
+    sql = R"(
+        DELETE FROM Inventory WHERE PlayerID = ? AND Slot = ?;
+        )";
+    sqlite3_stmt* remove = getStatement(sql);
+
+    for (int i = 0; i < AEQUIP_COUNT + AINVEN_COUNT + ABANK_COUNT; i++) {
+        sItemBase* item = itemSlot(player, i);
+        sItemBase* lastItem = last != nullptr ? itemSlot(last, i) : nullptr;
+
+        bool ok = true;
+        if (lastItem != nullptr && sameItem(item, lastItem)) {
+            continue; // unchanged
+        } else if (item->iID != 0) {
+            sqlite3_bind_int(upsert, 1, player->iID);
+            sqlite3_bind_int(upsert, 2, i);
+            sqlite3_bind_int(upsert, 3, item->iType);
+            sqlite3_bind_int(upsert, 4, item->iOpt);
+            sqlite3_bind_int(upsert, 5, item->iID);
+            sqlite3_bind_int(upsert, 6, item->iTimeLimit);
+            ok = stepStatement(upsert);
+        } else if (lastItem != nullptr && lastItem->iID != 0) {
+            sqlite3_bind_int(remove, 1, player->iID);
+            sqlite3_bind_int(remove, 2, i);
+            ok = stepStatement(remove);
+        } else {
+            continue; // was already empty
         }
-        sqlite3_reset(stmt);
-    }
-
-    for (int i = 0; i < ABANK_COUNT; i++) {
-        if (player->Bank[i].iID == 0)
-            continue;
 
-        sqlite3_bind_int(stmt, 1, player->iID);
-        sqlite3_bind_int(stmt, 2, i + AEQUIP_COUNT + AINVEN_COUNT);
-        sqlite3_bind_int(stmt, 3, player->Bank[i].iType);
-        sqlite3_bind_int(stmt, 4, player->Bank[i].iOpt);
-        sqlite3_bind_int(stmt, 5, player->Bank[i].iID);
-        sqlite3_bind_int(stmt, 6, player->Bank[i].iTimeLimit);
-
-        if (sqlite3_step(stmt) != SQLITE_DONE) {
-            std::cout << "[WARN] Database: Failed to save player to database: " << sqlite3_errmsg(db) << std::endl;
-            sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
-            sqlite3_finalize(stmt);
-            return;
+        if (!ok) {
+            releaseStatement(upsert);
+            releaseStatement(remove);
+            return -1;
         }
-        sqlite3_reset(stmt);
+        rows++;
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(upsert);
+    releaseStatement(remove);
 
     // Update Quest Inventory
+    if (last == nullptr && !deleteAll("QuestItems", player->iID))
+        return -1;
+
     sql = R"(
-        DELETE FROM QuestItems WHERE PlayerID = ?;
+        INSERT OR REPLACE INTO QuestItems (PlayerID, Slot, Opt, ID)
+        VALUES (?, ?, ?, ?);
         )";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    sqlite3_bind_int(stmt, 1, player->iID);
-    sqlite3_step(stmt);
-
-    sqlite3_finalize(stmt);
+    upsert = getStatement(sql);
 
     sql = R"(
-        INSERT INTO QuestItems (PlayerID, Slot, Opt, ID)
-        VALUES (?, ?, ?, ?);
+        DELETE FROM QuestItems WHERE PlayerID = ? AND Slot = ?;
         )";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    remove = getStatement(sql);
 
     for (int i = 0; i < AQINVEN_COUNT; i++) {
-        if (player->QInven[i].iID == 0)
+        sItemBase* item = &player->QInven[i];
+        sItemBase* lastItem = last != nullptr ? &last->QInven[i] : nullptr;
+
+        bool ok = true;
+        if (lastItem != nullptr && item->iID == lastItem->iID && item->iOpt == lastItem->iOpt) {
             continue;
+        } else if (item->iID != 0) {
+            sqlite3_bind_int(upsert, 1, player->iID);
+            sqlite3_bind_int(upsert, 2, i);
+            sqlite3_bind_int(upsert, 3, item->iOpt);
+            sqlite3_bind_int(upsert, 4, item->iID);
+            ok = stepStatement(upsert);
+        } else if (lastItem != nullptr && lastItem->iID != 0) {
+            sqlite3_bind_int(remove, 1, player->iID);
+            sqlite3_bind_int(remove, 2, i);
+            ok = stepStatement(remove);
+        } else {
+            continue;
+        }
 
-        sqlite3_bind_int(stmt, 1, player->iID);
-        sqlite3_bind_int(stmt, 2, i);
-        sqlite3_bind_int(stmt, 3, player->QInven[i].iOpt);
-        sqlite3_bind_int(stmt, 4, player->QInven[i].iID);
-
-        if (sqlite3_step(stmt) != SQLITE_DONE) {
-            std::cout << "[WARN] Database: Failed to save player to database: " << sqlite3_errmsg(db) << std::endl;
-            sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
-            sqlite3_finalize(stmt);
-            return;
+        if (!ok) {
+            releaseStatement(upsert);
+            releaseStatement(remove);
+            return -1;
         }
-        sqlite3_reset(stmt);
+        rows++;
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(upsert);
+    releaseStatement(remove);
+
+    // Update Nanos; rows are keyed by nano ID, which is also the index into Player::Nanos
+    if (last == nullptr && !deleteAll("Nanos", player->iID))
+        return -1;
 
-    // Update Nanos
     sql = R"(
-        DELETE FROM Nanos WHERE PlayerID = ?;
+        INSERT OR REPLACE INTO Nanos (PlayerID, ID, SKill, Stamina)
+        VALUES (?, ?, ?, ?);
         )";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    sqlite3_bind_int(stmt, 1, player->iID);
-    sqlite3_step(stmt);
-
-    sqlite3_finalize(stmt);
+    upsert = getStatement(sql);
 
     sql = R"(
-        INSERT INTO Nanos (PlayerID, ID, SKill, Stamina)
-        VALUES (?, ?, ?, ?);
+        DELETE FROM Nanos WHERE PlayerID = ? AND ID = ?;
         )";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    remove = getStatement(sql);
 
     for (int i = 0; i < NANO_COUNT; i++) {
-        if (player->Nanos[i].iID == 0)
+        sNano* nano = &player->Nanos[i];
+        sNano* lastNano = last != nullptr ? &last->Nanos[i] : nullptr;
+
+        bool ok = true;
+        if (lastNano != nullptr && nano->iID == lastNano->iID
+            && nano->iSkillID == lastNano->iSkillID && nano->iStamina == lastNano->iStamina) {
+            continue;
+        } else if (nano->iID != 0) {
+            sqlite3_bind_int(upsert, 1, player->iID);
+            sqlite3_bind_int(upsert, 2, nano->iID);
+            sqlite3_bind_int(upsert, 3, nano->iSkillID);
+            sqlite3_bind_int(upsert, 4, nano->iStamina);
+            ok = stepStatement(upsert);
+        } else if (lastNano != nullptr && lastNano->iID != 0) {
+            sqlite3_bind_int(remove, 1, player->iID);
+            sqlite3_bind_int(remove, 2, lastNano->iID);
+            ok = stepStatement(remove);
+        } else {
             continue;
+        }
 
-        sqlite3_bind_int(stmt, 1, player->iID);
-        sqlite3_bind_int(stmt, 2, player->Nanos[i].iID);
-        sqlite3_bind_int(stmt, 3, player->Nanos[i].iSkillID);
-        sqlite3_bind_int(stmt, 4, player->Nanos[i].iStamina);
-
-        if (sqlite3_step(stmt) != SQLITE_DONE) {
-            std::cout << "[WARN] Database: Failed to save player to database: " << sqlite3_errmsg(db) << std::endl;
-            sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
-            sqlite3_finalize(stmt);
-            return;
+        if (!ok) {
+            releaseStatement(upsert);
+            releaseStatement(remove);
+            return -1;
         }
-        sqlite3_reset(stmt);
+        rows++;
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(upsert);
+    releaseStatement(remove);
 
-    // Update Running Quests
-    sql = R"(
-        DELETE FROM RunningQuests WHERE PlayerID = ?;
-        )";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    sqlite3_bind_int(stmt, 1, player->iID);
-    sqlite3_step(stmt);
+    // Update Running Quests; there are only a handful and nothing to key them on, so replace them all
+    if (last != nullptr && !tasksChanged(player, last))
+        return rows;
 
-    sqlite3_finalize(stmt);
+    if (!deleteAll("RunningQuests", player->iID))
+        return -1;
 
     sql = R"(
         INSERT INTO RunningQuests
             (PlayerID, TaskID, RemainingNPCCount1, RemainingNPCCount2, RemainingNPCCount3)
         VALUES (?, ?, ?, ?, ?);
         )";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    stmt = getStatement(sql);
 
     for (int i = 0; i < ACTIVE_MISSION_COUNT; i++) {
         if (player->tasks[i] == 0)
@@ -526,15 +590,13 @@ void Database::updatePlayer(Player *player) {
         sqlite3_bind_int(stmt, 4, player->RemainingNPCCount[i][1]);
         sqlite3_bind_int(stmt, 5, player->RemainingNPCCount[i][2]);
 
-        if (sqlite3_step(stmt) != SQLITE_DONE) {
-            std::cout << "[WARN] Database: Failed to save player to database: " << sqlite3_errmsg(db) << std::endl;
-            sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
-            sqlite3_finalize(stmt);
-            return;
+        if (!stepStatement(stmt)) {
+            releaseStatement(stmt);
+            return -1;
         }
-        sqlite3_reset(stmt);
+        rows++;
     }
 
-    sqlite3_exec(db, "COMMIT;", NULL, NULL, NULL);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
+    return rows;
 }
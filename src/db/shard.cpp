@@ -14,12 +14,12 @@ static int getAccountIDFromPlayerID(int playerId, int *accountLevel=nullptr) {
     sqlite3_stmt *stmt;
 
     // get AccountID from PlayerID
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, playerId);
 
     if (sqlite3_step(stmt) != SQLITE_ROW) {
         std::cout << "[WARN] Database: failed to get AccountID from PlayerID: " << sqlite3_errmsg(db) << std::endl;
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return -1;
     }
 
@@ -29,7 +29,7 @@ static int getAccountIDFromPlayerID(int playerId, int *accountLevel=nullptr) {
     if (accountLevel != nullptr)
         *accountLevel = sqlite3_column_int(stmt, 1);
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     return accountId;
 }
@@ -42,9 +42,7 @@ static bool banAccount(int accountId, int days, std::string& reason) {
             BanReason = ?
         WHERE AccountID = ?;
         )";
-    sqlite3_stmt* stmt;
-
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
 
     sqlite3_bind_int(stmt, 1, days * 86400); // convert days to seconds
     sqlite3_bind_text(stmt, 2, reason.c_str(), -1, NULL);
@@ -52,11 +50,11 @@ static bool banAccount(int accountId, int days, std::string& reason) {
 
     if (sqlite3_step(stmt) != SQLITE_DONE) {
         std::cout << "[WARN] Database: failed to ban account: " << sqlite3_errmsg(db) << std::endl;
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return false;
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return true;
 }
 
@@ -68,19 +66,17 @@ static bool unbanAccount(int accountId) {
             BanReason = ''
         WHERE AccountID = ?;
         )";
-    sqlite3_stmt* stmt;
-
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
 
     sqlite3_bind_int(stmt, 1, accountId);
 
     if (sqlite3_step(stmt) != SQLITE_DONE) {
         std::cout << "[WARN] Database: failed to unban account: " << sqlite3_errmsg(db) << std::endl;
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return false;
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return true;
 }
 
@@ -88,7 +84,7 @@ static bool unbanAccount(int accountId) {
 #define THIRTY_YEARS 10957
 
 bool Database::banPlayer(int playerId, std::string& reason) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     int accountLevel;
     int accountId = getAccountIDFromPlayerID(playerId, &accountLevel);
@@ -110,7 +106,7 @@ bool Database::banPlayer(int playerId, std::string& reason) {
 }
 
 bool Database::unbanPlayer(int playerId) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     int accountId = getAccountIDFromPlayerID(playerId);
     if (accountId < 0)
@@ -122,89 +118,85 @@ bool Database::unbanPlayer(int playerId) {
 // buddies
 // returns num of buddies + blocked players
 int Database::getNumBuddies(Player* player) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     const char* sql = R"(
         SELECT COUNT(*)
         FROM Buddyships
         WHERE PlayerAID = ? OR PlayerBID = ?;
         )";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, player->iID);
     sqlite3_bind_int(stmt, 2, player->iID);
     sqlite3_step(stmt);
     int result = sqlite3_column_int(stmt, 0);
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     sql = R"(
         SELECT COUNT(*)
         FROM Blocks
         WHERE PlayerID = ?;
         )";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, player->iID);
     sqlite3_step(stmt);
     result += sqlite3_column_int(stmt, 0);
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     // again, for peace of mind
     return result > 50 ? 50 : result;
 }
 
 void Database::addBuddyship(int playerA, int playerB) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     const char* sql = R"(
         INSERT INTO Buddyships (PlayerAID, PlayerBID)
         VALUES (?, ?);
         )";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, playerA);
     sqlite3_bind_int(stmt, 2, playerB);
 
     if (sqlite3_step(stmt) != SQLITE_DONE)
         std::cout << "[WARN] Database: failed to add buddyship: " << sqlite3_errmsg(db) << std::endl;
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 }
 
 void Database::removeBuddyship(int playerA, int playerB) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     const char* sql = R"(
         DELETE FROM Buddyships
         WHERE (PlayerAID = ? AND PlayerBID = ?) OR (PlayerAID = ? AND PlayerBID = ?);
         )";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, playerA);
     sqlite3_bind_int(stmt, 2, playerB);
     sqlite3_bind_int(stmt, 3, playerB);
     sqlite3_bind_int(stmt, 4, playerA);
 
     sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 }
 
 // blocking
 void Database::addBlock(int playerId, int blockedPlayerId) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     const char* sql = R"(
         INSERT INTO Blocks (PlayerID, BlockedPlayerID)
         VALUES (?, ?);
         )";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, playerId);
     sqlite3_bind_int(stmt, 2, blockedPlayerId);
 
     if (sqlite3_step(stmt) != SQLITE_DONE)
         std::cout << "[WARN] Database: failed to block player: " << sqlite3_errmsg(db) << std::endl;
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 }
 
 void Database::removeBlock(int playerId, int blockedPlayerId) {
@@ -212,17 +204,16 @@ void Database::removeBlock(int playerId, int blockedPlayerId) {
         DELETE FROM Blocks
         WHERE PlayerID = ? AND BlockedPlayerID = ?;
         )";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, playerId);
     sqlite3_bind_int(stmt, 2, blockedPlayerId);
 
     sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 }
 
 RaceRanking Database::getTopRaceRanking(int epID, int playerID) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
     std::string sql(R"(
         SELECT
             EPID, PlayerID, Score, RingCount, Time, Timestamp
@@ -238,9 +229,7 @@ RaceRanking Database::getTopRaceRanking(int epID, int playerID) {
         LIMIT 1;
         )";
 
-    sqlite3_stmt* stmt;
-
-    sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql.c_str());
     sqlite3_bind_int(stmt, 1, epID);
     if(playerID > -1)
         sqlite3_bind_int(stmt, 2, playerID);
@@ -248,7 +237,7 @@ RaceRanking Database::getTopRaceRanking(int epID, int playerID) {
     RaceRanking ranking = {};
     if (sqlite3_step(stmt) != SQLITE_ROW) {
         // this race hasn't been run before, so return a blank ranking
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return ranking;
     }
 
@@ -261,21 +250,19 @@ RaceRanking Database::getTopRaceRanking(int epID, int playerID) {
     ranking.Time = sqlite3_column_int64(stmt, 4);
     ranking.Timestamp = sqlite3_column_int64(stmt, 5);
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return ranking;
 }
 
 void Database::postRaceRanking(RaceRanking ranking) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     const char* sql = R"(
         INSERT INTO RaceResults
             (EPID, PlayerID, Score, RingCount, Time, Timestamp)
         VALUES(?, ?, ?, ?, ?, ?);
         )";
-    sqlite3_stmt* stmt;
-
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, ranking.EPID);
     sqlite3_bind_int(stmt, 2, ranking.PlayerID);
     sqlite3_bind_int(stmt, 3, ranking.Score);
@@ -287,11 +274,11 @@ void Database::postRaceRanking(RaceRanking ranking) {
         std::cout << "[WARN] Database: Failed to post race result" << std::endl;
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 }
 
 bool Database::isCodeRedeemed(int playerId, std::string code) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     const char* sql = R"(
         SELECT COUNT(*)
@@ -299,31 +286,28 @@ bool Database::isCodeRedeemed(int playerId, std::string code) {
         WHERE PlayerID = ? AND Code = ?
         LIMIT 1;
         )";
-    sqlite3_stmt* stmt;
-
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, playerId);
     sqlite3_bind_text(stmt, 2, code.c_str(), -1, NULL);
     sqlite3_step(stmt);
     int result = sqlite3_column_int(stmt, 0);
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return result;
 }
 
 void Database::recordCodeRedemption(int playerId, std::string code) {
-    std::lock_guard<std::mutex> lock(dbCrit);
+    DBLock lock(dbCrit);
 
     const char* sql = R"(
         INSERT INTO RedeemedCodes (PlayerID, Code)
         VALUES (?, ?);
         )";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    sqlite3_stmt* stmt = getStatement(sql);
     sqlite3_bind_int(stmt, 1, playerId);
     sqlite3_bind_text(stmt, 2, code.c_str(), -1, NULL);
     
     if (sqlite3_step(stmt) != SQLITE_DONE)
         std::cout << "[WARN] Database: recording of code redemption failed: " << sqlite3_errmsg(db) << std::endl;
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 }
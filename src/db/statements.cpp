@@ -0,0 +1,138 @@
+#include "db/internal.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
+
+// Prepared statement cache.
+//
+// Each distinct SQL string is prepared once per connection, the first time it's used and then kept around; releasing a
+// statement only resets it and clears its bindings, so the next caller gets it ready to bind.
+// If the same statement is somehow needed twice at once, the second user gets a throwaway copy
+// that's finalized on release, same as before the cache existed.
+
+struct CachedStatement {
+    std::string sql;
+    sqlite3* conn;
+    sqlite3_stmt* stmt = nullptr;
+    bool inUse = false;
+
+    // profiling
+    uint64_t uses = 0;
+    uint64_t totalTime = 0; // us between getStatement() and releaseStatement()
+    std::chrono::steady_clock::time_point acquired;
+};
+
+static std::mutex cacheCrit; // the login and shard threads don't always hold dbCrit
+static std::unordered_map<sqlite3*, std::unordered_map<std::string, CachedStatement*>> cache;
+static std::unordered_map<sqlite3_stmt*, CachedStatement*> checkedOut; // nullptr for throwaway copies
+static uint64_t prepares = 0;
+
+sqlite3_stmt* getStatement(const char* sql, sqlite3* conn) {
+    std::lock_guard<std::mutex> lock(cacheCrit);
+
+    CachedStatement*& entry = cache[conn][sql];
+    if (entry == nullptr) {
+        entry = new CachedStatement();
+        entry->sql = sql;
+        entry->conn = conn;
+    }
+
+    sqlite3_stmt* stmt;
+    if (entry->inUse || entry->stmt == nullptr) {
+        prepares++;
+        if (sqlite3_prepare_v2(conn, sql, -1, &stmt, NULL) != SQLITE_OK) {
+            std::cout << "[WARN] Database: Failed to prepare statement: " << sqlite3_errmsg(conn) << std::endl;
+            return nullptr;
+        }
+
+        if (entry->inUse) {
+            checkedOut[stmt] = nullptr;
+            return stmt;
+        }
+        entry->stmt = stmt;
+    }
+
+    entry->inUse = true;
+    entry->acquired = std::chrono::steady_clock::now();
+    checkedOut[entry->stmt] = entry;
+    return entry->stmt;
+}
+
+void releaseStatement(sqlite3_stmt* stmt) {
+    if (stmt == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> lock(cacheCrit);
+
+    auto it = checkedOut.find(stmt);
+    if (it == checkedOut.end())
+        return; // released twice, or never came from here
+
+    CachedStatement* entry = it->second;
+    checkedOut.erase(it);
+
+    if (entry == nullptr) {
+        sqlite3_finalize(stmt);
+        return;
+    }
+
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    entry->inUse = false;
+
+    entry->uses++;
+    entry->totalTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - entry->acquired).count();
+}
+
+void finalizeStatements() {
+    std::lock_guard<std::mutex> lock(cacheCrit);
+
+    for (auto& pair : checkedOut)
+        sqlite3_finalize(pair.first);
+    checkedOut.clear();
+
+    for (auto& conn : cache) {
+        for (auto& pair : conn.second) {
+            if (pair.second->stmt != nullptr && !pair.second->inUse)
+                sqlite3_finalize(pair.second->stmt);
+            delete pair.second;
+        }
+    }
+    cache.clear();
+}
+
+void Database::printStatementStats() {
+    std::lock_guard<std::mutex> lock(cacheCrit);
+
+    std::vector<CachedStatement*> entries;
+    for (auto& conn : cache) {
+        for (auto& pair : conn.second)
+            entries.push_back(pair.second);
+    }
+
+    std::sort(entries.begin(), entries.end(), [](CachedStatement* a, CachedStatement* b) {
+        return a->totalTime > b->totalTime;
+    });
+
+    std::cout << "[INFO] Database: " << entries.size() << " cached statements, " << prepares << " prepares" << std::endl;
+    for (CachedStatement* entry : entries) {
+        if (entry->uses == 0)
+            continue;
+
+        // squash the SQL onto one line
+        std::string sql;
+        for (char c : entry->sql) {
+            if (isspace(c)) {
+                if (!sql.empty() && sql.back() != ' ')
+                    sql += ' ';
+            } else
+                sql += c;
+        }
+        if (sql.size() > 80)
+            sql = sql.substr(0, 77) + "...";
+
+        std::cout << "    " << entry->uses << " uses, " << entry->totalTime / 1000 << "ms total, "
+            << entry->totalTime / entry->uses << "us avg" << (entry->conn == readDb ? " (readDb)" : "") << ": " << sql << std::endl;
+    }
+}
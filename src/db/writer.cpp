@@ -0,0 +1,262 @@
+#include "db/internal.hpp"
+#include "settings.hpp"
+
+#if defined(__MINGW32__) && !defined(_GLIBCXX_HAS_GTHREADS)
+    #include "mingw/mingw.thread.h"
+#else
+    #include <thread>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+
+#if defined(__MINGW32__) && !defined(_GLIBCXX_HAS_GTHREADS)
+    #include "mingw/mingw.mutex.h"
+#else
+    #include <mutex>
+#endif
+
+// Write-behind player saves.
+//
+// updatePlayer() copies the player and pushes the copy onto a lock-free stack; a dedicated thread
+// takes everything pending in one go and writes it in a single transaction, so the shard thread
+// never waits on SQLite to save players. Only the newest snapshot of each player gets written.
+//
+// The thread also keeps a copy of what it last wrote for everyone that's online, and only writes
+// the rows that differ from it; players that haven't changed at all cost nothing beyond the compare.
+
+struct SaveNode {
+    Player snapshot;
+    bool final;
+    uint64_t seq;
+    SaveNode* next;
+};
+
+static std::atomic<SaveNode*> pending(nullptr);
+static std::atomic<uint64_t> savesQueued(0);
+static std::atomic<uint64_t> savesDone(0);
+
+// newest save queued and newest save finished (written or given up on) per player and per account,
+// so loading one character only has to wait for that character's saves; entries go once they match
+struct SaveSeqs {
+    uint64_t queued = 0;
+    uint64_t done = 0;
+};
+static std::mutex seqCrit;
+static std::unordered_map<int, SaveSeqs> seqsByPlayer;
+static std::unordered_map<int, SaveSeqs> seqsByAccount;
+
+static void markDone(std::unordered_map<int, SaveSeqs>& seqs, int key, uint64_t seq) {
+    auto it = seqs.find(key);
+    if (it == seqs.end())
+        return;
+
+    it->second.done = std::max(it->second.done, seq);
+    if (it->second.done >= it->second.queued)
+        seqs.erase(it);
+}
+
+// blocks until everything queued for key so far is done
+static void waitFor(std::unordered_map<int, SaveSeqs>& seqs, int key) {
+    uint64_t target;
+    {
+        std::lock_guard<std::mutex> lock(seqCrit);
+        auto it = seqs.find(key);
+        if (it == seqs.end())
+            return;
+        target = it->second.queued;
+    }
+
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(seqCrit);
+            auto it = seqs.find(key);
+            if (it == seqs.end() || it->second.done >= target)
+                return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+// player ID -> what was last written for them; only touched by the writer thread
+static std::unordered_map<int, Player*> lastWritten;
+
+static std::atomic<bool> writerRunning(false);
+static std::thread* writerThread = nullptr;
+
+static const int WRITER_IDLE = 10; // ms between checks for new work
+
+static void commitBatch(SaveNode* batch) {
+    // the stack hands things back newest first, so the first snapshot seen for a player is the one to keep
+    std::unordered_map<int, SaveNode*> newest;
+    std::vector<SaveNode*> order;
+    for (SaveNode* node = batch; node != nullptr; node = node->next) {
+        if (newest.find(node->snapshot.iID) != newest.end())
+            continue;
+
+        newest[node->snapshot.iID] = node;
+        order.push_back(node);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    int failed = 0, unchanged = 0, rows = 0;
+    std::vector<SaveNode*> written;
+
+    {
+        DBLock lock(dbCrit);
+
+        sqlite3_exec(db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+
+        // oldest first; a savepoint per player keeps one bad save from taking the whole batch with it
+        for (auto it = order.rbegin(); it != order.rend(); it++) {
+            Player* plr = &(*it)->snapshot;
+            auto last = lastWritten.find(plr->iID);
+
+            sqlite3_exec(db, "SAVEPOINT PlayerSave;", NULL, NULL, NULL);
+
+            int n = savePlayer(plr, last != lastWritten.end() ? last->second : nullptr);
+            if (n >= 0) {
+                sqlite3_exec(db, "RELEASE PlayerSave;", NULL, NULL, NULL);
+                written.push_back(*it);
+                rows += n;
+                if (n == 0)
+                    unchanged++;
+            } else {
+                // the DB still matches lastWritten, so the next save can diff against it as usual
+                sqlite3_exec(db, "ROLLBACK TO PlayerSave;", NULL, NULL, NULL);
+                sqlite3_exec(db, "RELEASE PlayerSave;", NULL, NULL, NULL);
+                failed++;
+            }
+        }
+
+        if (sqlite3_exec(db, "COMMIT;", NULL, NULL, NULL) != SQLITE_OK) {
+            std::cout << "[WARN] Database: Failed to commit player saves: " << sqlite3_errmsg(db) << std::endl;
+            sqlite3_exec(db, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
+
+            // no telling what made it to disk; start these players over with a full save
+            for (SaveNode* node : order) {
+                auto last = lastWritten.find(node->snapshot.iID);
+                if (last != lastWritten.end()) {
+                    delete last->second;
+                    lastWritten.erase(last);
+                }
+            }
+            failed = order.size();
+            written.clear();
+        }
+    }
+
+    for (SaveNode* node : written) {
+        Player*& last = lastWritten[node->snapshot.iID];
+        if (node->final) {
+            delete last;
+            lastWritten.erase(node->snapshot.iID);
+            continue;
+        }
+
+        if (last == nullptr)
+            last = new Player();
+        *last = node->snapshot;
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    if (settings::VERBOSITY > 1 || failed > 0)
+        std::cout << "[INFO] Database: Saved " << order.size() - failed << "/" << order.size()
+            << " players (" << unchanged << " unchanged), " << rows << " rows in " << elapsed.count() << "ms" << std::endl;
+
+    {
+        std::lock_guard<std::mutex> lock(seqCrit);
+        for (SaveNode* node = batch; node != nullptr; node = node->next) {
+            markDone(seqsByPlayer, node->snapshot.iID, node->seq);
+            markDone(seqsByAccount, node->snapshot.accountId, node->seq);
+        }
+    }
+
+    int count = 0;
+    while (batch != nullptr) {
+        SaveNode* next = batch->next;
+        delete batch;
+        batch = next;
+        count++;
+    }
+
+    savesDone += count;
+}
+
+static void writerLoop() {
+    for (;;) {
+        // check before draining, so whatever was queued before close() still gets written
+        bool stopping = !writerRunning;
+
+        SaveNode* batch = pending.exchange(nullptr, std::memory_order_acquire);
+        if (batch != nullptr) {
+            commitBatch(batch);
+            continue;
+        }
+
+        if (stopping)
+            break;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(WRITER_IDLE));
+    }
+}
+
+void Database::startWriter() {
+    writerRunning = true;
+    writerThread = new std::thread(writerLoop);
+}
+
+void Database::stopWriter() {
+    if (writerThread == nullptr)
+        return;
+
+    writerRunning = false;
+    writerThread->join();
+    delete writerThread;
+    writerThread = nullptr;
+}
+
+void Database::updatePlayer(Player *player, bool final) {
+    SaveNode* node = new SaveNode();
+    node->snapshot = *player;
+    node->final = final;
+    node->seq = ++savesQueued;
+
+    {
+        std::lock_guard<std::mutex> lock(seqCrit);
+        SaveSeqs& byPlayer = seqsByPlayer[player->iID];
+        byPlayer.queued = std::max(byPlayer.queued, node->seq);
+        SaveSeqs& byAccount = seqsByAccount[player->accountId];
+        byAccount.queued = std::max(byAccount.queued, node->seq);
+    }
+
+    node->next = pending.load(std::memory_order_relaxed);
+    while (!pending.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+        ; // node->next was refreshed with the current head; try again
+}
+
+void Database::flushPlayers() {
+    if (writerThread == nullptr)
+        return;
+
+    uint64_t target = savesQueued;
+    while (savesDone < target)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+void Database::flushPlayer(int playerID) {
+    if (writerThread != nullptr)
+        waitFor(seqsByPlayer, playerID);
+}
+
+void Database::flushAccount(int accountID) {
+    if (writerThread != nullptr)
+        waitFor(seqsByAccount, accountID);
+}
+
+bool Database::isPlayerSaved(int playerID) {
+    std::lock_guard<std::mutex> lock(seqCrit);
+    return seqsByPlayer.find(playerID) == seqsByPlayer.end();
+}
@@ -17,6 +17,7 @@
 #include "TableData.hpp"
 #include "Groups.hpp"
 #include "servers/Monitor.hpp"
+#include "servers/Handoff.hpp"
 #include "Racing.hpp"
 #include "Trading.hpp"
 #include "Email.hpp"
@@ -49,15 +50,23 @@ std::thread *shardThread = nullptr;
 
 void startShard(CNShardServer* server) {
     server->start();
+    MobAI::shutdown();
 }
 
 // terminate gracefully on SIGINT (for gprof & DB saving)
 void terminate(int arg) {
     std::cout << "OpenFusion: terminating." << std::endl;
 
-    if (shardServer != nullptr && shardThread != nullptr)
+    if (shardServer != nullptr) {
         shardServer->kill();
-    
+
+        // the mob AI workers can only be stopped from the shard's own thread
+        if (shardThread == nullptr || shardThread->get_id() == std::this_thread::get_id())
+            MobAI::shutdown();
+        else
+            shardThread->join(); // startShard() stops them on its way out
+    }
+
     Database::close();
     exit(0);
 }
@@ -84,7 +93,7 @@ void initsignals() {
 }
 #endif
 
-int main() {
+int main(int argc, char** argv) {
 #ifdef _WIN32
     WSADATA wsaData;
     if (WSAStartup(MAKEWORD(1, 1), &wsaData) != 0) {
@@ -96,6 +105,18 @@ int main() {
 #endif
     srand(getTime());
     settings::init();
+
+    // "fusion login" or "fusion shard [port]" override the config file, so several shards can share one
+    if (argc > 1)
+        settings::SERVERMODE = argv[1];
+    if (argc > 2)
+        settings::SHARDPORT = atoi(argv[2]);
+
+    if (settings::SERVERMODE != "combined" && settings::SERVERMODE != "login" && settings::SERVERMODE != "shard") {
+        std::cout << "[FATAL] Unknown server mode " << settings::SERVERMODE << "; expected combined, login or shard" << std::endl;
+        exit(1);
+    }
+
     std::cout << "[INFO] OpenFusion v" GIT_VERSION << std::endl;
     std::cout << "[INFO] Protocol version: " << PROTOCOL_VERSION << std::endl;
     std::cout << "[INFO] Intializing Packet Managers..." << std::endl;
@@ -133,82 +154,36 @@ int main() {
         /* not reached */
     }
 
-    std::cout << "[INFO] Starting Server Threads..." << std::endl;
-    CNLoginServer loginServer(settings::LOGINPORT);
-    shardServer = new CNShardServer(settings::SHARDPORT);
+    if (settings::SERVERMODE == "shard") {
+        std::cout << "[INFO] Starting Shard Server..." << std::endl;
+        shardServer = new CNShardServer(settings::SHARDPORT);
+        Handoff::connect(shardServer);
 
-    shardThread = new std::thread(startShard, (CNShardServer*)shardServer);
+        shardServer->start();
 
-    loginServer.start();
+        MobAI::shutdown();
+        shardServer->kill();
+    } else if (settings::SERVERMODE == "login") {
+        std::cout << "[INFO] Starting Login Server..." << std::endl;
+        CNLoginServer loginServer(settings::LOGINPORT);
+        Handoff::listen(&loginServer);
 
-    shardServer->kill();
-    shardThread->join();
+        loginServer.start();
+    } else {
+        std::cout << "[INFO] Starting Server Threads..." << std::endl;
+        CNLoginServer loginServer(settings::LOGINPORT);
+        shardServer = new CNShardServer(settings::SHARDPORT);
 
-#ifdef _WIN32
-    WSACleanup();
-#endif
-    return 0;
-}
+        shardThread = new std::thread(startShard, (CNShardServer*)shardServer);
 
-// helper functions
+        loginServer.start();
 
-std::string U16toU8(char16_t* src, size_t max) {
-    src[max-1] = '\0'; // force a NULL terminatorstd::string U16toU8(char16_t* src) {
-    try {
-        std::wstring_convert<std::codecvt_utf8_utf16<char16_t>,char16_t> convert;
-        return convert.to_bytes(src);
-    } catch(const std::exception& e) {
-        return "";
+        shardServer->kill();
+        shardThread->join();
     }
-}
-
-// returns number of char16_t that was written at des
-size_t U8toU16(std::string src, char16_t* des, size_t max) {
-    std::wstring_convert<std::codecvt_utf8_utf16<char16_t>,char16_t> convert;
-    std::u16string tmp = convert.from_bytes(src);
-
-    // copy utf16 string to buffer
-    if (sizeof(char16_t) * tmp.length() > max) // make sure we don't write outside the buffer
-        memcpy(des, tmp.c_str(), sizeof(char16_t) * max);
-    else
-        memcpy(des, tmp.c_str(), sizeof(char16_t) * tmp.length());
-    des[tmp.length()] = '\0';
 
-    return tmp.length();
-}
-
-time_t getTime() {
-    using namespace std::chrono;
-
-    milliseconds value = duration_cast<milliseconds>((time_point_cast<milliseconds>(high_resolution_clock::now())).time_since_epoch());
-
-    return (time_t)value.count();
-}
-
-// returns system time in seconds
-time_t getTimestamp() {
-    using namespace std::chrono;
-
-    seconds value = duration_cast<seconds>((time_point_cast<seconds>(system_clock::now())).time_since_epoch());
-
-    return (time_t)value.count();
-}
-
-// convert integer timestamp (in s) to FF systime struct
-sSYSTEMTIME timeStampToStruct(uint64_t time) {
-
-    const time_t timeProper = time;
-    tm ts = *localtime(&timeProper);
-
-    sSYSTEMTIME systime;
-    systime.wMilliseconds = 0;
-    systime.wSecond = ts.tm_sec;
-    systime.wMinute = ts.tm_min;
-    systime.wHour = ts.tm_hour;
-    systime.wDay = ts.tm_mday;
-    systime.wDayOfWeek = ts.tm_wday + 1;
-    systime.wMonth = ts.tm_mon + 1;
-    systime.wYear = ts.tm_year + 1900;
-
-    return systime;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+    return 0;
 }
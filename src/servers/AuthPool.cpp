@@ -0,0 +1,114 @@
+#include "servers/AuthPool.hpp"
+#include "settings.hpp"
+#include "bcrypt/BCrypt.hpp"
+
+#if defined(__MINGW32__) && !defined(_GLIBCXX_HAS_GTHREADS)
+    #include "mingw/mingw.mutex.h"
+    #include "mingw/mingw.thread.h"
+#else
+    #include <mutex>
+    #include <thread>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iostream>
+
+static std::mutex queueCrit;
+static std::mutex pollCrit; // held by whichever idle worker is watching the queue
+static std::deque<AuthPool::Job> queue;
+static std::vector<AuthPool::Job> done; // also guarded by queueCrit
+
+static uint64_t nextID = 1;
+static std::atomic<size_t> outstandingJobs(0);
+
+static const int WORKER_IDLE = 2; // ms between checks for new work
+
+static void work(AuthPool::Job& job) {
+    try {
+        if (job.type == AuthPool::JobType::VERIFY) {
+            job.ok = BCrypt::validatePassword(job.password, job.hash);
+        } else {
+            job.hash = BCrypt::generateHash(job.password);
+            job.ok = true;
+        }
+    } catch (const std::exception& err) {
+        std::cout << "[WARN] Auth worker: " << err.what() << std::endl;
+        job.ok = false;
+    }
+
+    job.password.clear(); // don't keep plaintext around any longer than needed
+}
+
+/*
+ * Only one idle worker polls the queue at a time; the others wait on pollCrit, so an idle
+ * server has a single thread waking up no matter how many there are.
+ */
+static void workerLoop() {
+    for (;;) {
+        AuthPool::Job job;
+        {
+            std::lock_guard<std::mutex> poller(pollCrit);
+            while (job.id == 0) {
+                {
+                    std::lock_guard<std::mutex> lock(queueCrit);
+                    if (!queue.empty()) {
+                        job = std::move(queue.front());
+                        queue.pop_front();
+                        break;
+                    }
+                }
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(WORKER_IDLE));
+            }
+        }
+
+        work(job);
+
+        std::lock_guard<std::mutex> lock(queueCrit);
+        done.push_back(std::move(job));
+    }
+}
+
+void AuthPool::init() {
+    int threads = settings::AUTHTHREADS;
+    if (threads <= 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // these live as long as the server does
+    for (int i = 0; i < threads; i++)
+        std::thread(workerLoop).detach();
+
+    std::cout << "[INFO] Using " << threads << " password hashing threads" << std::endl;
+}
+
+uint64_t AuthPool::submit(JobType type, std::string password, std::string hash) {
+    Job job;
+    job.type = type;
+    job.password = password;
+    job.hash = hash;
+
+    std::lock_guard<std::mutex> lock(queueCrit);
+    job.id = nextID++;
+    queue.push_back(std::move(job));
+    outstandingJobs++;
+
+    return queue.back().id;
+}
+
+std::vector<AuthPool::Job> AuthPool::collect() {
+    std::vector<Job> finished;
+    {
+        std::lock_guard<std::mutex> lock(queueCrit);
+        finished.swap(done);
+    }
+
+    outstandingJobs -= finished.size();
+    return finished;
+}
+
+size_t AuthPool::outstanding() {
+    return outstandingJobs;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Worker threads for bcrypt.
+ *
+ * Hashing and checking passwords is slow on purpose, so the login server hands that work off to
+ * here and picks the results back up from its own loop with collect(), instead of stalling every
+ * other connection while one login is being checked.
+ */
+namespace AuthPool {
+    enum class JobType {
+        VERIFY,
+        HASH
+    };
+
+    struct Job {
+        uint64_t id = 0;
+        JobType type = JobType::VERIFY;
+        std::string password;
+        std::string hash; // the stored hash for VERIFY, the result for HASH
+        bool ok = false; // VERIFY: the password matched; HASH: hashing succeeded
+    };
+
+    void init();
+
+    // returns the job's id, which comes back with the result
+    uint64_t submit(JobType type, std::string password, std::string hash="");
+    // takes every job that's finished since the last call
+    std::vector<Job> collect();
+    // submitted but not yet collected
+    size_t outstanding();
+}
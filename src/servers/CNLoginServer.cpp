@@ -3,17 +3,22 @@
 #include "db/Database.hpp"
 #include "PlayerManager.hpp"
 #include "Items.hpp"
-#include <regex>
-#include "bcrypt/BCrypt.hpp"
+#include "servers/AuthPool.hpp"
+#include "servers/Credentials.hpp"
+#include "servers/Handoff.hpp"
 
 #include "settings.hpp"
 
 std::map<CNSocket*, CNLoginData> CNLoginServer::loginSessions;
+std::unordered_map<uint64_t, PendingLogin> CNLoginServer::pendingLogins;
+std::unordered_map<CNSocket*, sP_CL2LS_REQ_CHAR_SELECT> CNLoginServer::heldSelects;
 
 CNLoginServer::CNLoginServer(uint16_t p) {
     port = p;
     pHandler = &CNLoginServer::handlePacket;
     init();
+
+    AuthPool::init();
 }
 
 void CNLoginServer::handlePacket(CNSocket* sock, CNPacketData* data) {
@@ -93,6 +98,12 @@ void CNLoginServer::login(CNSocket* sock, CNPacketData* data) {
     if (data->size != sizeof(sP_CL2LS_REQ_LOGIN))
         return; // ignore the malformed packet
 
+    // already waiting on a password check for this connection
+    for (auto& pair : pendingLogins) {
+        if (pair.second.sock == sock)
+            return;
+    }
+
     sP_CL2LS_REQ_LOGIN* login = (sP_CL2LS_REQ_LOGIN*)data->buf;
     // TODO: implement better way of sending credentials
     std::string userLogin((char*)login->szCookie_TEGid);
@@ -102,7 +113,7 @@ void CNLoginServer::login(CNSocket* sock, CNPacketData* data) {
      * Sometimes the client sends garbage cookie data.
      * Validate it as normal credentials instead of using a length check before falling back.
      */
-    if (!CNLoginServer::isLoginDataGood(userLogin, userPassword)) {
+    if (!Credentials::isLoginDataGood(userLogin, userPassword)) {
         /*
          * The std::string -> char* -> std::string maneuver should remove any
          * trailing garbage after the null terminator.
@@ -116,8 +127,8 @@ void CNLoginServer::login(CNSocket* sock, CNPacketData* data) {
     if (int(userPassword.find("\n")) > 0)
         userPassword.erase(userPassword.find("\n"), 1);
 
-    // check regex
-    if (!CNLoginServer::isLoginDataGood(userLogin, userPassword)) {
+    // check the credentials are well-formed
+    if (!Credentials::isLoginDataGood(userLogin, userPassword)) {
         // send a custom error message
         INITSTRUCT(sP_FE2CL_GM_REP_PC_ANNOUNCE, msg);
         std::string text = "Invalid login or password\n";
@@ -134,13 +145,59 @@ void CNLoginServer::login(CNSocket* sock, CNPacketData* data) {
 
     Database::Account findUser = {};
     Database::findAccount(&findUser, userLogin);
-    
-    // account was not found
-    if (findUser.AccountID == 0)
-        return newAccount(sock, userLogin, userPassword, login->iClientVerC);
 
-    if (!CNLoginServer::isPasswordCorrect(findUser.Password, userPassword))
-        return loginFail(LoginError::ID_AND_PASSWORD_DO_NOT_MATCH, userLogin, sock);
+    PendingLogin pending;
+    pending.sock = sock;
+    pending.req = *login;
+    pending.userLogin = userLogin;
+    pending.account = findUser;
+
+    // bcrypt is slow, so the rest happens in resumeLogins() once a worker is done with it
+    if (findUser.AccountID == 0) {
+        // account was not found; hash the password for a new one
+        pending.password = userPassword;
+        pendingLogins[AuthPool::submit(AuthPool::JobType::HASH, userPassword)] = pending;
+        return;
+    }
+
+    pendingLogins[AuthPool::submit(AuthPool::JobType::VERIFY, userPassword, findUser.Password)] = pending;
+}
+
+void CNLoginServer::resumeLogins() {
+    for (AuthPool::Job& job : AuthPool::collect()) {
+        auto it = pendingLogins.find(job.id);
+        if (it == pendingLogins.end())
+            continue; // they disconnected in the meantime
+
+        PendingLogin pending = it->second;
+        pendingLogins.erase(it);
+
+        if (pending.account.AccountID == 0) {
+            // another first login to the same name may have created it while this one was hashing
+            Database::findAccount(&pending.account, pending.userLogin);
+            if (pending.account.AccountID != 0) {
+                std::string password = pending.password;
+                pending.password.clear();
+                pendingLogins[AuthPool::submit(AuthPool::JobType::VERIFY, password, pending.account.Password)] = pending;
+            } else if (!job.ok) {
+                loginFail(LoginError::DATABASE_ERROR, pending.userLogin, pending.sock);
+            } else {
+                newAccount(pending.sock, pending.userLogin, job.hash, pending.req.iClientVerC);
+            }
+        } else if (!job.ok) {
+            loginFail(LoginError::ID_AND_PASSWORD_DO_NOT_MATCH, pending.userLogin, pending.sock);
+        } else {
+            finishLogin(pending);
+        }
+    }
+}
+
+// everything after the password check
+void CNLoginServer::finishLogin(PendingLogin& pending) {
+    CNSocket* sock = pending.sock;
+    sP_CL2LS_REQ_LOGIN* login = &pending.req;
+    std::string& userLogin = pending.userLogin;
+    Database::Account& findUser = pending.account;
 
     // is the account banned
     if (findUser.BannedUntil > getTimestamp()) {
@@ -220,9 +277,9 @@ void CNLoginServer::login(CNSocket* sock, CNPacketData* data) {
     )
 }
 
-void CNLoginServer::newAccount(CNSocket* sock, std::string userLogin, std::string userPassword, int32_t clientVerC) {   
+void CNLoginServer::newAccount(CNSocket* sock, std::string userLogin, std::string hashedPassword, int32_t clientVerC) {
 
-    int userID = Database::addAccount(userLogin, userPassword);
+    int userID = Database::addAccount(userLogin, hashedPassword);
     // if query somehow failed
     if (userID == 0)
         return loginFail(LoginError::DATABASE_ERROR, userLogin, sock);
@@ -288,7 +345,7 @@ void CNLoginServer::nameSave(CNSocket* sock, CNPacketData* data) {
     INITSTRUCT(sP_LS2CL_REP_SAVE_CHAR_NAME_SUCC, resp);
 
     int errorCode = 0;
-    if (!CNLoginServer::isCharacterNameGood(AUTOU16TOU8(save->szFirstName), AUTOU16TOU8(save->szLastName))) {
+    if (!Credentials::isCharacterNameGood(AUTOU16TOU8(save->szFirstName), AUTOU16TOU8(save->szLastName))) {
         errorCode = 4;
     } else if (!Database::isNameFree(AUTOU16TOU8(save->szFirstName), AUTOU16TOU8(save->szLastName))) {
         errorCode = 1;
@@ -447,6 +504,29 @@ void CNLoginServer::characterSelect(CNSocket* sock, CNPacketData* data) {
         return;
 
     sP_CL2LS_REQ_CHAR_SELECT* selection = (sP_CL2LS_REQ_CHAR_SELECT*)data->buf;
+
+    // their last shard may not have written out their last session yet; picked back up in resumeSelects()
+    if (settings::SERVERMODE == "login" && Handoff::holdForSave(loginSessions[sock].userID)) {
+        heldSelects[sock] = *selection;
+        return;
+    }
+
+    selectCharacter(sock, selection);
+}
+
+void CNLoginServer::resumeSelects() {
+    for (auto it = heldSelects.begin(); it != heldSelects.end();) {
+        if (Handoff::holdForSave(loginSessions[it->first].userID)) {
+            it++;
+            continue;
+        }
+
+        selectCharacter(it->first, &it->second);
+        it = heldSelects.erase(it);
+    }
+}
+
+void CNLoginServer::selectCharacter(CNSocket* sock, sP_CL2LS_REQ_CHAR_SELECT* selection) {
     // we're doing a small hack and immediately send SHARD_SELECT_SUCC
     INITSTRUCT(sP_LS2CL_REP_SHARD_SELECT_SUCC, resp);
 
@@ -482,7 +562,17 @@ void CNLoginServer::characterSelect(CNSocket* sock, CNPacketData* data) {
 
     passPlayer.FEKey = sock->getFEKey();
     resp.iEnterSerialKey = passPlayer.iID;
-    CNSharedData::setPlayer(resp.iEnterSerialKey, passPlayer);
+
+    if (settings::SERVERMODE == "login") {
+        uint16_t port;
+        if (!Handoff::sendPlayer(resp.iEnterSerialKey, passPlayer, &port)) {
+            std::cout << "[WARN] Login Server: No shards are up to send " << PlayerManager::getPlayerName(&passPlayer) << " to" << std::endl;
+            return invalidCharacter(sock);
+        }
+        resp.g_FE_ServerPort = port;
+    } else {
+        CNSharedData::setPlayer(resp.iEnterSerialKey, passPlayer);
+    }
 
     sock->sendPacket((void*)&resp, P_LS2CL_REP_SHARD_SELECT_SUCC, sizeof(sP_LS2CL_REP_SHARD_SELECT_SUCC));
 
@@ -513,7 +603,7 @@ void CNLoginServer::changeName(CNSocket* sock, CNPacketData* data) {
     sP_CL2LS_REQ_CHANGE_CHAR_NAME* save = (sP_CL2LS_REQ_CHANGE_CHAR_NAME*)data->buf;
 
     int errorCode = 0;
-    if (!CNLoginServer::isCharacterNameGood(AUTOU16TOU8(save->szFirstName), AUTOU16TOU8(save->szLastName))) {
+    if (!Credentials::isCharacterNameGood(AUTOU16TOU8(save->szFirstName), AUTOU16TOU8(save->szLastName))) {
         errorCode = 4;
     }
     else if (!Database::isNameFree(AUTOU16TOU8(save->szFirstName), AUTOU16TOU8(save->szLastName))) {
@@ -581,9 +671,31 @@ void CNLoginServer::killConnection(CNSocket* cns) {
         std::cout << "Login Server: Account [" << loginSessions[cns].userID << "] disconnected from login server" << std::endl;
     )
     loginSessions.erase(cns);
+    heldSelects.erase(cns);
+
+    // drop any login still waiting on a worker, so its result doesn't go to a dead socket
+    for (auto it = pendingLogins.begin(); it != pendingLogins.end();) {
+        if (it->second.sock == cns)
+            it = pendingLogins.erase(it);
+        else
+            it++;
+    }
+}
+
+bool CNLoginServer::checkExtraSockets(SOCKET fd, int revents) {
+    return Handoff::checkSocket(fd, revents);
+}
+
+int CNLoginServer::pollTimeout() {
+    // don't leave finished logins (or handoffs the kernel didn't take yet) sitting around for a whole poll timeout
+    return AuthPool::outstanding() > 0 || Handoff::pending() ? 5 : CNServer::pollTimeout();
 }
 
 void CNLoginServer::onStep() {
+    resumeLogins();
+    resumeSelects();
+    Handoff::flush(); // before the shard select replies go out, so players can't beat their handoff
+
     time_t currTime = getTime();
     static time_t lastCheck = 0;
 
@@ -628,22 +740,4 @@ bool CNLoginServer::exitDuplicate(int accountId) {
     }
     return false;
 }
-
-bool CNLoginServer::isLoginDataGood(std::string login, std::string password) {
-    std::regex loginRegex("[a-zA-Z0-9_-]{4,32}");
-    std::regex passwordRegex("[a-zA-Z0-9!@#$%^&*()_+]{8,32}");
-
-    return (std::regex_match(login, loginRegex) && std::regex_match(password, passwordRegex));
-}
-
-bool CNLoginServer::isPasswordCorrect(std::string actualPassword, std::string tryPassword) {
-    return BCrypt::validatePassword(tryPassword, actualPassword);
-}
-
-bool CNLoginServer::isCharacterNameGood(std::string Firstname, std::string Lastname) {
-    //Allow alphanumeric and dot characters in names(disallows dot and space characters at the beginning of a name)
-    std::regex firstnamecheck(R"(((?! )(?!\.)[a-zA-Z0-9]*\.{0,1}(?!\.+ +)[a-zA-Z0-9]* {0,1}(?! +))*$)");
-    std::regex lastnamecheck(R"(((?! )(?!\.)[a-zA-Z0-9]*\.{0,1}(?!\.+ +)[a-zA-Z0-9]* {0,1}(?! +))*$)");
-    return (std::regex_match(Firstname, firstnamecheck) && std::regex_match(Lastname, lastnamecheck));
-}
 #pragma endregion
@@ -2,8 +2,10 @@
 
 #include "core/Core.hpp"
 #include "Player.hpp"
+#include "db/Database.hpp"
 
 #include <map>
+#include <unordered_map>
 
 struct CNLoginData {
     int userID;
@@ -22,33 +24,47 @@ enum class LoginError {
     UPDATED_EUALA_REQUIRED = 9
 };
 
+// a login that's waiting on AuthPool to check (or hash) its password
+struct PendingLogin {
+    CNSocket* sock;
+    sP_CL2LS_REQ_LOGIN req;
+    std::string userLogin;
+    Database::Account account;
+    std::string password; // only kept for new accounts, in case someone else creates it first
+};
+
 // WARNING: THERE CAN ONLY BE ONE OF THESE SERVERS AT A TIME!!!!!! TODO: change loginSessions & packet handlers to be non-static
 class CNLoginServer : public CNServer {
 private:
     static void handlePacket(CNSocket* sock, CNPacketData* data);
     static std::map<CNSocket*, CNLoginData> loginSessions;
+    static std::unordered_map<uint64_t, PendingLogin> pendingLogins; // AuthPool job id -> login
+    static std::unordered_map<CNSocket*, sP_CL2LS_REQ_CHAR_SELECT> heldSelects; // waiting on Handoff::holdForSave()
 
     static void login(CNSocket* sock, CNPacketData* data);
+    static void resumeLogins();
+    static void finishLogin(PendingLogin& pending);
     static void nameCheck(CNSocket* sock, CNPacketData* data);
     static void nameSave(CNSocket* sock, CNPacketData* data);
     static void characterCreate(CNSocket* sock, CNPacketData* data);
     static void characterDelete(CNSocket* sock, CNPacketData* data);
     static void characterSelect(CNSocket* sock, CNPacketData* data);
+    static void selectCharacter(CNSocket* sock, sP_CL2LS_REQ_CHAR_SELECT* selection);
+    static void resumeSelects();
     static void finishTutorial(CNSocket* sock, CNPacketData* data);
     static void changeName(CNSocket* sock, CNPacketData* data);
     static void duplicateExit(CNSocket* sock, CNPacketData* data);
 
-    static bool isLoginDataGood(std::string login, std::string password);
-    static bool isPasswordCorrect(std::string actualPassword, std::string tryPassword);
     static bool isAccountInUse(int accountId);
-    static bool isCharacterNameGood(std::string Firstname, std::string Lastname);
-    static void newAccount(CNSocket* sock, std::string userLogin, std::string userPassword, int32_t clientVerC);
+    static void newAccount(CNSocket* sock, std::string userLogin, std::string hashedPassword, int32_t clientVerC);
     // returns true if success
     static bool exitDuplicate(int accountId);
 public:
     CNLoginServer(uint16_t p);
 
+    bool checkExtraSockets(SOCKET fd, int revents);
     void newConnection(CNSocket* cns);
     void killConnection(CNSocket* cns);
     void onStep();
+    int pollTimeout();
 };
@@ -1,6 +1,7 @@
 #include "core/Core.hpp"
 #include "db/Database.hpp"
 #include "servers/Monitor.hpp"
+#include "servers/Handoff.hpp"
 #include "servers/CNShardServer.hpp"
 #include "PlayerManager.hpp"
 #include "MobAI.hpp"
@@ -11,19 +12,21 @@
 #include <iostream>
 #include <sstream>
 #include <cstdlib>
+#include <algorithm>
+#include <chrono>
 
 std::map<uint32_t, PacketHandler> CNShardServer::ShardPackets;
 std::list<TimerEvent> CNShardServer::Timers;
+TimerWheel CNShardServer::Wheel;
 
 CNShardServer::CNShardServer(uint16_t p) {
     port = p;
     pHandler = &CNShardServer::handlePacket;
-    REGISTER_SHARD_TIMER(keepAliveTimer, 4000);
     REGISTER_SHARD_TIMER(periodicSaveTimer, settings::DBSAVEINTERVAL*1000);
     init();
 
     if (settings::MONITORENABLED)
-        fds.push_back({Monitor::init(), POLLIN});
+        addPollFD(Monitor::init());
 }
 
 void CNShardServer::handlePacket(CNSocket* sock, CNPacketData* data) {
@@ -38,17 +41,33 @@ void CNShardServer::handlePacket(CNSocket* sock, CNPacketData* data) {
         PlayerManager::players[sock]->lastHeartbeat = getTime();
 }
 
-void CNShardServer::keepAliveTimer(CNServer* serv, time_t currTime) {
-    for (auto& pair : PlayerManager::players) {
-        if (pair.second->lastHeartbeat != 0 && currTime - pair.second->lastHeartbeat > settings::TIMEOUT) {
-            // if the client hasn't responded in 60 seconds, its a dead connection so throw it out
-            pair.first->kill();
-        } else if (pair.second->lastHeartbeat != 0 && currTime - pair.second->lastHeartbeat > settings::TIMEOUT/2) {
-            // if the player hasn't responded in 30 seconds, send a live check
-            INITSTRUCT(sP_FE2CL_REQ_LIVE_CHECK, data);
-            pair.first->sendPacket((void*)&data, P_FE2CL_REQ_LIVE_CHECK, sizeof(sP_FE2CL_REQ_LIVE_CHECK));
-        }
+void CNShardServer::startKeepAlive(CNSocket* sock) {
+    Player* plr = PlayerManager::getPlayer(sock);
+    plr->keepAliveTimer = Wheel.schedule(getTime() + settings::TIMEOUT/2, [sock](time_t t) { keepAliveCheck(sock, t); });
+}
+
+// each player has exactly one of these pending; it's cancelled in PlayerManager::removePlayer()
+void CNShardServer::keepAliveCheck(CNSocket* sock, time_t currTime) {
+    Player* plr = PlayerManager::getPlayer(sock);
+    time_t next;
+
+    if (plr->lastHeartbeat == 0) {
+        next = currTime + settings::TIMEOUT/2;
+    } else if (currTime - plr->lastHeartbeat > settings::TIMEOUT) {
+        // if the client hasn't responded in 60 seconds, its a dead connection so throw it out
+        sock->kill();
+        return;
+    } else if (currTime - plr->lastHeartbeat > settings::TIMEOUT/2) {
+        // if the player hasn't responded in 30 seconds, send a live check every 4 seconds until they do
+        INITSTRUCT(sP_FE2CL_REQ_LIVE_CHECK, data);
+        sock->sendPacket((void*)&data, P_FE2CL_REQ_LIVE_CHECK, sizeof(sP_FE2CL_REQ_LIVE_CHECK));
+        next = std::min(currTime + 4000, plr->lastHeartbeat + settings::TIMEOUT + 1);
+    } else {
+        // heard from them recently; nothing to do until they've been quiet for long enough
+        next = plr->lastHeartbeat + settings::TIMEOUT/2 + 1;
     }
+
+    plr->keepAliveTimer = Wheel.schedule(next, [sock](time_t t) { keepAliveCheck(sock, t); });
 }
 
 void CNShardServer::periodicSaveTimer(CNServer* serv, time_t currTime) {
@@ -57,16 +76,20 @@ void CNShardServer::periodicSaveTimer(CNServer* serv, time_t currTime) {
 
     std::cout << "[INFO] Saving " << PlayerManager::players.size() << " players to DB..." << std::endl;
 
+    // this only snapshots the players; the writes themselves happen on the DB thread.
+    // the time reported is how long the shard was held up by it.
+    auto start = std::chrono::steady_clock::now();
     for (auto& pair : PlayerManager::players) {
         Database::updatePlayer(pair.second);
     }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
 
     TableData::flush();
-    std::cout << "[INFO] Done." << std::endl;
+    std::cout << "[INFO] Done. Players queued in " << elapsed.count() << "us" << std::endl;
 }
 
-bool CNShardServer::checkExtraSockets(int i) {
-    return Monitor::acceptConnection(fds[i].fd, fds[i].revents);
+bool CNShardServer::checkExtraSockets(SOCKET fd, int revents) {
+    return Monitor::acceptConnection(fd, revents) || Handoff::checkSocket(fd, revents);
 }
 
 void CNShardServer::newConnection(CNSocket* cns) {
@@ -96,23 +119,42 @@ void CNShardServer::killConnection(CNSocket *cns) {
 // flush the DB when terminating the server
 void CNShardServer::kill() {
     periodicSaveTimer(nullptr, 0);
+    Database::flushPlayers();
     CNServer::kill();
 }
 
+// calls a registered timer and puts it back on the wheel for its next run
+void CNShardServer::runTimer(CNServer* serv, TimerHandler handlr, time_t delta, time_t currTime) {
+    handlr(serv, currTime);
+    Wheel.schedule(currTime + delta, [=](time_t t) { runTimer(serv, handlr, delta, t); });
+}
+
 void CNShardServer::onStep() {
     time_t currTime = getTime();
 
+    // move any newly registered timers onto the wheel
     for (TimerEvent& event : Timers) {
-        if (event.scheduledEvent == 0) {
-            // event hasn't been queued yet, go ahead and do that
-            event.scheduledEvent = currTime + event.delta;
-            continue;
-        }
-
-        if (event.scheduledEvent < currTime) {
-            // timer needs to be called
-            event.handlr(this, currTime);
-            event.scheduledEvent = currTime + event.delta;
-        }
+        TimerHandler handlr = event.handlr;
+        time_t delta = event.delta;
+        Wheel.schedule(currTime + delta, [this, handlr, delta](time_t t) { runTimer(this, handlr, delta, t); });
     }
+    Timers.clear();
+
+    Wheel.advance(currTime);
+    Handoff::flush();
+}
+
+// sleep until the next deadline instead of waking up on a fixed interval
+int CNShardServer::pollTimeout() {
+    if (!Timers.empty())
+        return 0; // get them scheduled right away
+    if (Handoff::pending())
+        return 5;
+
+    time_t next = Wheel.nextDeadline();
+    if (next == -1)
+        return MAXPOLLTIMEOUT;
+
+    time_t wait = next - getTime();
+    return (int)std::max((time_t)0, std::min(wait, (time_t)MAXPOLLTIMEOUT));
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/Core.hpp"
+#include "core/TimerWheel.hpp"
 
 #include <map>
 
@@ -11,20 +12,26 @@ class CNShardServer : public CNServer {
 private:
     static void handlePacket(CNSocket* sock, CNPacketData* data);
 
-    static void keepAliveTimer(CNServer*, time_t);
+    static const int MAXPOLLTIMEOUT = 1000; // ms
+
+    static void keepAliveCheck(CNSocket* sock, time_t currTime);
     static void periodicSaveTimer(CNServer* serv, time_t currTime);
+    static void runTimer(CNServer* serv, TimerHandler handlr, time_t delta, time_t currTime);
 
 public:
     static std::map<uint32_t, PacketHandler> ShardPackets;
-    static std::list<TimerEvent> Timers;
+    static std::list<TimerEvent> Timers; // registered but not yet on the wheel
+    static TimerWheel Wheel;
 
     CNShardServer(uint16_t p);
 
     static void _killConnection(CNSocket *cns);
+    static void startKeepAlive(CNSocket* sock);
 
-    bool checkExtraSockets(int i);
+    bool checkExtraSockets(SOCKET fd, int revents);
     void newConnection(CNSocket* cns);
     void killConnection(CNSocket* cns);
     void kill();
     void onStep();
+    int pollTimeout();
 };
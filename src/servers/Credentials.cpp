@@ -0,0 +1,75 @@
+#include "servers/Credentials.hpp"
+
+/*
+ * These used to be std::regex checks, constructing their patterns on every call. The hand-written
+ * versions accept exactly the same strings:
+ *
+ *   login:    [a-zA-Z0-9_-]{4,32}
+ *   password: [a-zA-Z0-9!@#$%^&*()_+]{8,32}
+ *   name:     ((?! )(?!\.)[a-zA-Z0-9]*\.{0,1}(?!\.+ +)[a-zA-Z0-9]* {0,1}(?! +))*$
+ *
+ * The name pattern boils down to: alphanumerics, dots and spaces, not starting with a dot or a space,
+ * with no two dots or two spaces in a row and no dot right after a space. Empty names pass, same as before.
+ * tests/credentials.cpp holds these up against the original patterns.
+ */
+static bool isAlnum(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+static bool isLoginChar(char c) {
+    return isAlnum(c) || c == '_' || c == '-';
+}
+
+static bool isPasswordChar(char c) {
+    if (isAlnum(c))
+        return true;
+
+    switch (c) {
+    case '!': case '@': case '#': case '$': case '%': case '^':
+    case '&': case '*': case '(': case ')': case '_': case '+':
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool isNameGood(const std::string& name) {
+    char prev = 0;
+    for (size_t i = 0; i < name.size(); i++) {
+        char c = name[i];
+        if (c == ' ') {
+            if (i == 0 || prev == ' ')
+                return false;
+        } else if (c == '.') {
+            if (i == 0 || prev == '.' || prev == ' ')
+                return false;
+        } else if (!isAlnum(c)) {
+            return false;
+        }
+        prev = c;
+    }
+
+    return true;
+}
+
+bool Credentials::isLoginDataGood(const std::string& login, const std::string& password) {
+    if (login.size() < 4 || login.size() > 32 || password.size() < 8 || password.size() > 32)
+        return false;
+
+    for (char c : login) {
+        if (!isLoginChar(c))
+            return false;
+    }
+
+    for (char c : password) {
+        if (!isPasswordChar(c))
+            return false;
+    }
+
+    return true;
+}
+
+bool Credentials::isCharacterNameGood(const std::string& Firstname, const std::string& Lastname) {
+    // alphanumeric and dot characters in names (disallows dot and space characters at the beginning of a name)
+    return isNameGood(Firstname) && isNameGood(Lastname);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+/*
+ * Checks on what players type in at the login screen. These don't touch the database or any
+ * server state, so they're kept apart from CNLoginServer.
+ */
+namespace Credentials {
+    bool isLoginDataGood(const std::string& login, const std::string& password);
+    bool isCharacterNameGood(const std::string& Firstname, const std::string& Lastname);
+}
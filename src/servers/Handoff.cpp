@@ -0,0 +1,563 @@
+#include "servers/Handoff.hpp"
+#include "servers/CNShardServer.hpp"
+#include "core/CNShared.hpp"
+#include "PlayerManager.hpp"
+#include "db/Database.hpp"
+#include "settings.hpp"
+
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#ifndef _WIN32
+    #include <sys/stat.h>
+    #include <sys/un.h>
+#endif
+
+/*
+ * Every message is a header followed by size bytes of body:
+ *
+ *   HELLO   shard -> login   HelloMsg, once right after connecting
+ *   STATUS  shard -> login   StatusMsg, every STATUS_INTERVAL
+ *   PLAYER  login -> shard   serial key (int64_t), then the Player
+ *   KICK    login -> shard   KickMsg; that account just went to another shard, or wants to
+ *   SAVED   shard -> login   SavedMsg; that account has left and its final save is on disk,
+ *                            or it wasn't on the shard when asked to leave
+ *
+ * Bump HANDOFF_VERSION whenever any of these change.
+ */
+static const uint32_t HANDOFF_VERSION = 2;
+static const time_t STATUS_INTERVAL = 2000; // ms; also how often a shard retries the login server
+static const uint32_t MAX_MESSAGE = sizeof(int64_t) + sizeof(Player);
+
+enum class MsgType : uint32_t {
+    HELLO = 1,
+    STATUS,
+    PLAYER,
+    KICK,
+    SAVED
+};
+
+struct MsgHeader {
+    uint32_t type;
+    uint32_t size;
+};
+
+struct HelloMsg {
+    uint32_t version;
+    uint32_t playerSize; // a cheap check that both ends agree on what a Player is
+    uint16_t port;
+};
+
+struct StatusMsg {
+    int32_t players;
+};
+
+struct KickMsg {
+    int32_t accountId;
+};
+
+struct SavedMsg {
+    int32_t accountId;
+};
+
+// shard side; players that have left, whose final save hasn't been written yet
+struct LeftPlayer {
+    int32_t accountId;
+    int32_t playerId;
+};
+
+struct Peer {
+    std::vector<uint8_t> inbuf;
+    std::vector<uint8_t> outbuf;
+    uint16_t port = 0; // the shard's; 0 until it says hello
+    int players = 0; // as of the last status report, plus anyone sent there since
+};
+
+static CNServer* server = nullptr;
+static bool listening = false;
+static SOCKET listener; // login side
+static bool connected = false;
+static SOCKET loginSock; // shard side
+static std::unordered_map<SOCKET, Peer> peers; // shards, or just the login server
+
+// login side; account -> port of the shard it was last sent to, until that shard reports it saved
+static std::unordered_map<int32_t, uint16_t> inPlay;
+static std::unordered_map<int32_t, bool> kickSent; // accounts we've already asked their shard to let go of
+
+// shard side
+static std::vector<LeftPlayer> unsaved;
+
+static void closeSocket(SOCKET fd) {
+#ifdef _WIN32
+    shutdown(fd, SD_BOTH);
+    closesocket(fd);
+#else
+    shutdown(fd, SHUT_RDWR);
+    close(fd);
+#endif
+}
+
+// unlike setSockNonblocking(), leaves closing the socket on failure to the caller
+static bool setNonblocking(SOCKET fd) {
+#ifdef _WIN32
+    unsigned long mode = 1;
+    if (ioctlsocket(fd, FIONBIO, &mode) != 0) {
+#else
+    if (fcntl(fd, F_SETFL, (fcntl(fd, F_GETFL, 0) | O_NONBLOCK)) != 0) {
+#endif
+        printSocketError("fcntl");
+        return false;
+    }
+    return true;
+}
+
+/*
+ * The socket file is only accessible to our own user, but something could bind the path while the
+ * login server is down, so both ends also check who's on the other side. Players carry their FE key,
+ * so nothing running as anyone else gets to see them, or hand us made-up ones.
+ */
+static bool peerIsUs(SOCKET fd) {
+#ifdef _WIN32
+    return false;
+#else
+    uid_t uid;
+#ifdef __linux__
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) {
+        printSocketError("getsockopt");
+        return false;
+    }
+    uid = cred.uid;
+#else
+    gid_t gid;
+    if (getpeereid(fd, &uid, &gid) != 0) {
+        printSocketError("getpeereid");
+        return false;
+    }
+#endif
+
+    if (uid != geteuid()) {
+        std::cout << "[WARN] Refused a handoff connection from uid " << uid << ", which isn't us" << std::endl;
+        return false;
+    }
+    return true;
+#endif
+}
+
+static void dropPeer(SOCKET fd) {
+    if (connected && fd == loginSock) {
+        std::cout << "[WARN] Lost connection to the login server; no new players can join until it's back" << std::endl;
+        connected = false;
+    } else if (peers[fd].port != 0) {
+        std::cout << "[WARN] Lost connection to the shard on port " << peers[fd].port << std::endl;
+
+        // whatever it hadn't saved yet isn't going to be, so there's no point holding anyone up for it
+        for (auto it = inPlay.begin(); it != inPlay.end();) {
+            if (it->second == peers[fd].port) {
+                kickSent.erase(it->first);
+                it = inPlay.erase(it);
+            } else {
+                it++;
+            }
+        }
+    }
+
+    server->removePollFD(fd);
+    closeSocket(fd);
+    peers.erase(fd);
+}
+
+static void queue(Peer& peer, MsgType type, const void* body, size_t size) {
+    MsgHeader header = {(uint32_t)type, (uint32_t)size};
+    peer.outbuf.insert(peer.outbuf.end(), (uint8_t*)&header, (uint8_t*)&header + sizeof(header));
+    peer.outbuf.insert(peer.outbuf.end(), (uint8_t*)body, (uint8_t*)body + size);
+}
+
+// false if the connection died, or should be dropped
+static bool handleMessage(Peer& peer, MsgType type, const uint8_t* body, uint32_t size) {
+    // only take messages that are meant to come our way
+    bool fromShard = type == MsgType::HELLO || type == MsgType::STATUS || type == MsgType::SAVED;
+    if (fromShard != listening) {
+        std::cout << "[WARN] Handoff message " << (uint32_t)type << " came from the wrong end; dropping the connection" << std::endl;
+        return false;
+    }
+
+    switch (type) {
+    case MsgType::HELLO: {
+        if (size != sizeof(HelloMsg))
+            return false;
+
+        HelloMsg hello;
+        memcpy(&hello, body, sizeof(hello));
+        if (hello.version != HANDOFF_VERSION || hello.playerSize != sizeof(Player)) {
+            std::cout << "[WARN] Turned away a shard from a different build of the server" << std::endl;
+            return false;
+        }
+
+        peer.port = hello.port;
+        std::cout << "[INFO] Shard on port " << peer.port << " connected" << std::endl;
+        return true;
+    }
+    case MsgType::STATUS: {
+        if (size != sizeof(StatusMsg))
+            return false;
+
+        StatusMsg status;
+        memcpy(&status, body, sizeof(status));
+        peer.players = status.players;
+        return true;
+    }
+    case MsgType::PLAYER: {
+        if (size != sizeof(int64_t) + sizeof(Player))
+            return false;
+
+        int64_t serialKey;
+        Player plr;
+        memcpy(&serialKey, body, sizeof(serialKey));
+        // Players go over the wire as raw bytes on purpose (see above); the cast is just to say so to the compiler
+        memcpy((void*)&plr, body + sizeof(serialKey), sizeof(Player));
+        CNSharedData::setPlayer(serialKey, plr);
+        return true;
+    }
+    case MsgType::KICK: {
+        if (size != sizeof(KickMsg))
+            return false;
+
+        KickMsg kick;
+        memcpy(&kick, body, sizeof(kick));
+        PlayerManager::exitDuplicate(kick.accountId);
+
+        // if they're here (or just left), SAVED goes out once their save is in; otherwise say so right away
+        if (!PlayerManager::isAccountInUse(kick.accountId)) {
+            bool leaving = false;
+            for (LeftPlayer& left : unsaved)
+                leaving |= left.accountId == kick.accountId;
+
+            if (!leaving) {
+                SavedMsg saved = {kick.accountId};
+                queue(peer, MsgType::SAVED, &saved, sizeof(saved));
+            }
+        }
+        return true;
+    }
+    case MsgType::SAVED: {
+        if (size != sizeof(SavedMsg))
+            return false;
+
+        SavedMsg saved;
+        memcpy(&saved, body, sizeof(saved));
+
+        // other shards answer KICKs too; only the one they were sent to counts
+        auto it = inPlay.find(saved.accountId);
+        if (it != inPlay.end() && it->second == peer.port) {
+            inPlay.erase(it);
+            kickSent.erase(saved.accountId);
+        }
+        return true;
+    }
+    default:
+        std::cout << "[WARN] Unknown handoff message " << (uint32_t)type << std::endl;
+        return false;
+    }
+}
+
+// reads until the socket would block and handles every complete message; false if the connection died
+static bool receive(SOCKET fd, Peer& peer) {
+    uint8_t buf[4096];
+    for (;;) {
+        int n = recv(fd, (char*)buf, sizeof(buf), 0);
+        if (n > 0) {
+            peer.inbuf.insert(peer.inbuf.end(), buf, buf + n);
+            continue;
+        }
+
+        if (n == 0)
+            return false; // closed on the other end
+        if (OF_ERRNO == OF_EWOULD)
+            break;
+
+        printSocketError("recv");
+        return false;
+    }
+
+    size_t pos = 0;
+    while (peer.inbuf.size() - pos >= sizeof(MsgHeader)) {
+        MsgHeader header;
+        memcpy(&header, &peer.inbuf[pos], sizeof(header));
+        if (header.size > MAX_MESSAGE)
+            return false;
+        if (peer.inbuf.size() - pos - sizeof(header) < header.size)
+            break; // rest of it hasn't arrived yet
+
+        if (!handleMessage(peer, (MsgType)header.type, peer.inbuf.data() + pos + sizeof(header), header.size))
+            return false;
+        pos += sizeof(header) + header.size;
+    }
+
+    peer.inbuf.erase(peer.inbuf.begin(), peer.inbuf.begin() + pos);
+    return true;
+}
+
+void Handoff::flush() {
+    // shard side; tell the login server about players whose final save has made it to disk
+    for (size_t i = 0; i < unsaved.size();) {
+        if (!Database::isPlayerSaved(unsaved[i].playerId)) {
+            i++;
+            continue;
+        }
+
+        // if the login server is gone, so is whatever it was waiting on
+        if (connected) {
+            SavedMsg saved = {unsaved[i].accountId};
+            queue(peers[loginSock], MsgType::SAVED, &saved, sizeof(saved));
+        }
+
+        unsaved[i] = unsaved.back();
+        unsaved.pop_back();
+    }
+
+    std::vector<SOCKET> dead;
+
+    for (auto& pair : peers) {
+        std::vector<uint8_t>& outbuf = pair.second.outbuf;
+
+        size_t sent = 0;
+        while (sent < outbuf.size()) {
+            int n = send(pair.first, (char*)outbuf.data() + sent, outbuf.size() - sent, 0);
+            if (SOCKETERROR(n)) {
+                if (OF_ERRNO != OF_EWOULD) {
+                    printSocketError("send");
+                    dead.push_back(pair.first);
+                }
+                break;
+            }
+            sent += n;
+        }
+        outbuf.erase(outbuf.begin(), outbuf.begin() + sent);
+    }
+
+    for (SOCKET fd : dead)
+        dropPeer(fd);
+}
+
+bool Handoff::pending() {
+    if (!unsaved.empty())
+        return true;
+
+    for (auto& pair : peers) {
+        if (!pair.second.outbuf.empty())
+            return true;
+    }
+    return false;
+}
+
+bool Handoff::checkSocket(SOCKET fd, int revents) {
+    if (listening && fd == listener) {
+        if (revents & ~POLLIN) {
+            std::cout << "[FATAL] Error on handoff listener socket" << std::endl;
+            terminate(0);
+        }
+
+        // accept everything that's pending, since edge-triggered backends won't tell us again
+        for (;;) {
+            SOCKET sock = accept(listener, NULL, NULL);
+            if (SOCKETINVALID(sock)) {
+                if (OF_ERRNO != OF_EWOULD)
+                    printSocketError("accept");
+                return true;
+            }
+
+            if (!peerIsUs(sock) || !setNonblocking(sock)) {
+                closeSocket(sock);
+                continue;
+            }
+
+            peers[sock] = Peer();
+            server->addPollFD(sock);
+        }
+    }
+
+    auto it = peers.find(fd);
+    if (it == peers.end())
+        return false;
+
+    if (!receive(fd, it->second))
+        dropPeer(fd);
+    return true;
+}
+
+void Handoff::listen(CNServer* serv) {
+#ifdef _WIN32
+    std::cout << "[FATAL] Running the login server on its own needs Unix domain sockets, which this build doesn't have" << std::endl;
+    exit(1);
+#else
+    server = serv;
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (settings::HANDOFFSOCKET.size() >= sizeof(address.sun_path)) {
+        std::cout << "[FATAL] Handoff socket path is too long: " << settings::HANDOFFSOCKET << std::endl;
+        exit(1);
+    }
+    strcpy(address.sun_path, settings::HANDOFFSOCKET.c_str());
+
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (SOCKETERROR(listener)) {
+        std::cout << "[FATAL] Failed to create handoff socket" << std::endl;
+        printSocketError("socket");
+        exit(1);
+    }
+
+    unlink(settings::HANDOFFSOCKET.c_str()); // left behind by the last run
+    if (SOCKETERROR(bind(listener, (struct sockaddr*)&address, sizeof(address)))) {
+        std::cout << "[FATAL] Failed to bind handoff socket to " << settings::HANDOFFSOCKET << std::endl;
+        printSocketError("bind");
+        exit(1);
+    }
+
+    if (chmod(settings::HANDOFFSOCKET.c_str(), S_IRUSR | S_IWUSR) != 0) {
+        std::cout << "[FATAL] Failed to restrict access to the handoff socket" << std::endl;
+        printSocketError("chmod");
+        exit(1);
+    }
+
+    if (SOCKETERROR(::listen(listener, SOMAXCONN))) {
+        std::cout << "[FATAL] Failed to listen on handoff socket" << std::endl;
+        printSocketError("listen");
+        exit(1);
+    }
+
+    if (fcntl(listener, F_SETFL, (fcntl(listener, F_GETFL, 0) | O_NONBLOCK)) != 0) {
+        std::cerr << "[FATAL] OpenFusion: fcntl failed" << std::endl;
+        printSocketError("fcntl");
+        exit(EXIT_FAILURE);
+    }
+
+    listening = true;
+    server->addPollFD(listener);
+    std::cout << "[INFO] Waiting for shards on " << settings::HANDOFFSOCKET << std::endl;
+#endif
+}
+
+bool Handoff::sendPlayer(int64_t serialKey, Player& plr, uint16_t* port) {
+    Peer* best = nullptr;
+    for (auto& pair : peers) {
+        if (pair.second.port != 0 && (best == nullptr || pair.second.players < best->players))
+            best = &pair.second;
+    }
+
+    if (best == nullptr)
+        return false;
+
+    std::vector<uint8_t> body(sizeof(serialKey) + sizeof(Player));
+    memcpy(&body[0], &serialKey, sizeof(serialKey));
+    memcpy(&body[sizeof(serialKey)], &plr, sizeof(Player));
+    queue(*best, MsgType::PLAYER, body.data(), body.size());
+    best->players++; // so a burst of logins doesn't all land on the same shard before it next reports in
+    inPlay[plr.accountId] = best->port;
+
+    // each shard only kicks duplicate logins among its own players
+    KickMsg kick = {plr.accountId};
+    for (auto& pair : peers) {
+        if (&pair.second != best && pair.second.port != 0)
+            queue(pair.second, MsgType::KICK, &kick, sizeof(kick));
+    }
+
+    *port = best->port;
+    return true;
+}
+
+bool Handoff::holdForSave(int32_t accountId) {
+    auto it = inPlay.find(accountId);
+    if (it == inPlay.end())
+        return false;
+
+    // they may well still be playing there; ask the shard to let them go, which it answers with SAVED
+    if (!kickSent[accountId]) {
+        for (auto& pair : peers) {
+            if (pair.second.port == it->second) {
+                KickMsg kick = {accountId};
+                queue(pair.second, MsgType::KICK, &kick, sizeof(kick));
+            }
+        }
+        kickSent[accountId] = true;
+    }
+
+    return true;
+}
+
+void Handoff::playerLeft(Player* plr) {
+    unsaved.push_back({plr->accountId, plr->iID});
+}
+
+static bool tryConnect() {
+#ifdef _WIN32
+    return false;
+#else
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, settings::HANDOFFSOCKET.c_str(), sizeof(address.sun_path) - 1);
+
+    SOCKET sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (SOCKETERROR(sock)) {
+        printSocketError("socket");
+        return false;
+    }
+
+    if (SOCKETERROR(connect(sock, (struct sockaddr*)&address, sizeof(address)))) {
+        closeSocket(sock);
+        return false;
+    }
+
+    if (!peerIsUs(sock) || !setNonblocking(sock)) {
+        closeSocket(sock);
+        return false;
+    }
+
+    loginSock = sock;
+    connected = true;
+    server->addPollFD(sock);
+
+    HelloMsg hello = {HANDOFF_VERSION, sizeof(Player), (uint16_t)settings::SHARDPORT};
+    queue(peers[sock], MsgType::HELLO, &hello, sizeof(hello));
+
+    std::cout << "[INFO] Connected to the login server at " << settings::HANDOFFSOCKET << std::endl;
+    return true;
+#endif
+}
+
+static void statusTimer(CNServer* serv, time_t currTime) {
+    if (!connected && !tryConnect())
+        return;
+
+    StatusMsg status = {(int32_t)PlayerManager::players.size()};
+    queue(peers[loginSock], MsgType::STATUS, &status, sizeof(status));
+}
+
+void Handoff::connect(CNServer* serv) {
+#ifdef _WIN32
+    std::cout << "[FATAL] Running a shard on its own needs Unix domain sockets, which this build doesn't have" << std::endl;
+    exit(1);
+#else
+    if (settings::HANDOFFSOCKET.size() >= sizeof(sockaddr_un::sun_path)) {
+        std::cout << "[FATAL] Handoff socket path is too long: " << settings::HANDOFFSOCKET << std::endl;
+        exit(1);
+    }
+
+    server = serv;
+    if (!tryConnect())
+        std::cout << "[WARN] No login server at " << settings::HANDOFFSOCKET << " yet; will keep trying" << std::endl;
+
+    REGISTER_SHARD_TIMER(statusTimer, STATUS_INTERVAL);
+#endif
+}
+
+void Handoff::receivePending() {
+    if (!connected)
+        return;
+
+    if (!receive(loginSock, peers[loginSock]))
+        dropPeer(loginSock);
+}
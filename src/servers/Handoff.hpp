@@ -0,0 +1,41 @@
+#pragma once
+
+#include "core/Core.hpp"
+#include "Player.hpp"
+
+/*
+ * Channel between a login server and its shards, for running them as separate processes
+ * (settings::SERVERMODE "login" and "shard").
+ *
+ * The login server listens on a Unix domain socket (settings::HANDOFFSOCKET) and each shard connects
+ * to it, saying which port it takes players on and periodically how many it has. Only processes
+ * running as the same user can get in on either end. When a character is selected, the login
+ * server passes the Player to the least busy shard, where it lands in CNSharedData just like it
+ * does when both servers share a process.
+ * Both ends are always the same build, so Players are sent as they are in memory.
+ *
+ * Not available on Windows; there, the login and shard servers always share a process.
+ */
+namespace Handoff {
+    // login server side
+    void listen(CNServer* serv);
+    // false if no shards are connected; otherwise port is set to the shard the client should go to
+    bool sendPlayer(int64_t serialKey, Player& plr, uint16_t* port);
+    /*
+     * True while the shard the account was last sent to hasn't reported their final save as written, in
+     * which case the database may still have their old data. Asks that shard to let them go if needed.
+     */
+    bool holdForSave(int32_t accountId);
+
+    // shard side; keeps retrying in the background if the login server isn't up yet
+    void connect(CNServer* serv);
+    // reads whatever the login server has sent so far, for players that beat their own handoff here
+    void receivePending();
+    // tells the login server once the player's final save (already queued) has been written
+    void playerLeft(Player* plr);
+
+    // both sides; called from checkExtraSockets(), onStep() and pollTimeout() respectively
+    bool checkSocket(SOCKET fd, int revents);
+    void flush();
+    bool pending();
+}
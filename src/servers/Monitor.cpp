@@ -79,7 +79,7 @@ outer:
     Chat::dump.clear();
 }
 
-bool Monitor::acceptConnection(SOCKET fd, uint16_t revents) {
+bool Monitor::acceptConnection(SOCKET fd, int revents) {
     socklen_t len = sizeof(address);
 
     if (!settings::MONITORENABLED)
@@ -93,23 +93,26 @@ bool Monitor::acceptConnection(SOCKET fd, uint16_t revents) {
         terminate(0);
     }
 
-    int sock = accept(listener, (struct sockaddr*)&address, &len);
-    if (SOCKETERROR(sock)) {
-        printSocketError("accept");
-        return true;
-    }
+    // accept everything that's pending, since edge-triggered backends won't tell us again
+    for (;;) {
+        int sock = accept(listener, (struct sockaddr*)&address, &len);
+        if (SOCKETERROR(sock)) {
+            if (OF_ERRNO != OF_EWOULD)
+                printSocketError("accept");
+            return true;
+        }
 
-    setSockNonblocking(listener, sock);
+        if (!setSockNonblocking(listener, sock))
+            continue;
 
-    std::cout << "[INFO] New monitor connection from " << inet_ntoa(address.sin_addr) << std::endl;
+        std::cout << "[INFO] New monitor connection from " << inet_ntoa(address.sin_addr) << std::endl;
 
-    {
-        std::lock_guard<std::mutex> lock(sockLock);
+        {
+            std::lock_guard<std::mutex> lock(sockLock);
 
-        sockets.push_back(sock);
+            sockets.push_back(sock);
+        }
     }
-
-    return true;
 }
 
 SOCKET Monitor::init() {
@@ -7,5 +7,5 @@
 
 namespace Monitor {
     SOCKET init();
-    bool acceptConnection(SOCKET, uint16_t);
+    bool acceptConnection(SOCKET, int);
 };
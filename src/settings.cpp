@@ -8,15 +8,27 @@
 // defaults :)
 int settings::VERBOSITY = 1;
 
+#ifdef __linux__
+std::string settings::EVENTLOOP = "epoll";
+#else
+std::string settings::EVENTLOOP = "poll";
+#endif
+int settings::SENDBUFFERLIMIT = 262144;
+time_t settings::SENDBUFFERTIMEOUT = 10000;
+std::string settings::SERVERMODE = "combined";
+std::string settings::HANDOFFSOCKET = "handoff.sock";
+
 int settings::LOGINPORT = 23000;
 bool settings::APPROVEALLNAMES = true;
 int settings::DBSAVEINTERVAL = 240;
+int settings::AUTHTHREADS = 2;
 
 int settings::SHARDPORT = 23001;
 std::string settings::SHARDSERVERIP = "127.0.0.1";
 time_t settings::TIMEOUT = 60000;
 int settings::VIEWDISTANCE = 25600;
 bool settings::SIMULATEMOBS = true;
+int settings::MOBAITHREADS = 0;
 
 // default spawn point
 #ifndef ACADEMY
@@ -36,6 +48,7 @@ std::string settings::NPCJSON = "tdata/NPCs.json";
 std::string settings::MOBJSON = "tdata/mobs.json";
 std::string settings::EGGSJSON = "tdata/eggs.json";
 std::string settings::GRUNTWORKJSON = "tdata/gruntwork.json";
+std::string settings::TDATACACHE = "tdata.cache";
 std::string settings::MOTDSTRING = "Welcome to OpenFusion!";
 std::string settings::DBPATH = "database.db";
 std::string settings::ACADEMYJSON = "tdata/1013/academy.json";
@@ -77,13 +90,20 @@ void settings::init() {
 
     APPROVEALLNAMES = reader.GetBoolean("", "acceptallcustomnames", APPROVEALLNAMES);
     VERBOSITY = reader.GetInteger("", "verbosity", VERBOSITY);
+    EVENTLOOP = reader.Get("", "eventloop", EVENTLOOP);
+    SENDBUFFERLIMIT = reader.GetInteger("", "sendbufferlimit", SENDBUFFERLIMIT);
+    SENDBUFFERTIMEOUT = reader.GetInteger("", "sendbuffertimeout", SENDBUFFERTIMEOUT);
+    SERVERMODE = reader.Get("", "servermode", SERVERMODE);
+    HANDOFFSOCKET = reader.Get("", "handoffsocket", HANDOFFSOCKET);
     LOGINPORT = reader.GetInteger("login", "port", LOGINPORT);
     SHARDPORT = reader.GetInteger("shard", "port", SHARDPORT);
     DBSAVEINTERVAL = reader.GetInteger("login", "dbsaveinterval", DBSAVEINTERVAL);
+    AUTHTHREADS = reader.GetInteger("login", "auththreads", AUTHTHREADS);
     SHARDSERVERIP = reader.Get("shard", "ip", "127.0.0.1");
     TIMEOUT = reader.GetInteger("shard", "timeout", TIMEOUT);
     VIEWDISTANCE = reader.GetInteger("shard", "viewdistance", VIEWDISTANCE);
     SIMULATEMOBS = reader.GetBoolean("shard", "simulatemobs", SIMULATEMOBS);
+    MOBAITHREADS = reader.GetInteger("shard", "mobaithreads", MOBAITHREADS);
     SPAWN_X = reader.GetInteger("shard", "spawnx", SPAWN_X);
     SPAWN_Y = reader.GetInteger("shard", "spawny", SPAWN_Y);
     SPAWN_Z = reader.GetInteger("shard", "spawnz", SPAWN_Z);
@@ -97,6 +117,7 @@ void settings::init() {
     EGGSJSON = reader.Get("shard", "eggdata", EGGSJSON);
     PATHJSON = reader.Get("shard", "pathdata", PATHJSON);
     GRUNTWORKJSON = reader.Get("shard", "gruntwork", GRUNTWORKJSON);
+    TDATACACHE = reader.Get("shard", "tdatacache", TDATACACHE);
     MOTDSTRING = reader.Get("shard", "motd", MOTDSTRING);
     DBPATH = reader.Get("shard", "dbpath", DBPATH);
     ACCLEVEL = reader.GetInteger("shard", "accountlevel", ACCLEVEL);
@@ -2,14 +2,21 @@
 
 namespace settings {
     extern int VERBOSITY;
+    extern std::string EVENTLOOP;
+    extern int SENDBUFFERLIMIT;
+    extern time_t SENDBUFFERTIMEOUT;
+    extern std::string SERVERMODE;
+    extern std::string HANDOFFSOCKET;
     extern int LOGINPORT;
     extern bool APPROVEALLNAMES;
     extern int DBSAVEINTERVAL;
+    extern int AUTHTHREADS;
     extern int SHARDPORT;
     extern std::string SHARDSERVERIP;
     extern time_t TIMEOUT;
     extern int VIEWDISTANCE;
     extern bool SIMULATEMOBS;
+    extern int MOBAITHREADS;
     extern int SPAWN_X;
     extern int SPAWN_Y;
     extern int SPAWN_Z;
@@ -25,6 +32,7 @@ namespace settings {
     extern std::string DROPSJSON;
     extern std::string EGGSJSON;
     extern std::string GRUNTWORKJSON;
+    extern std::string TDATACACHE;
     extern std::string DBPATH;
     extern int EVENTMODE;
     extern int EVENTCRATECHANCE;
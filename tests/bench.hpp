@@ -0,0 +1,35 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+
+/*
+ * Micro-benchmarks, built as the bench target (or `make bench`). They aren't run by ctest;
+ * run bin/bench (or the bench binary in the build directory) with the names of the ones you
+ * want, or with none to run them all. Build with optimizations on for numbers worth comparing.
+ */
+
+// average nanoseconds per call of fn over runs calls
+template<typename F>
+double nsPerRun(long runs, F fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < runs; i++)
+        fn(i);
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / runs;
+}
+
+// keeps the compiler from optimizing away a result nothing else reads
+template<typename T>
+void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+void benchEventLoop();
+void benchChunkMap();
+void benchTimers();
+void benchMobs();
+void benchStatements();
+void benchPlayers();
+void benchPools();
@@ -0,0 +1,40 @@
+#include "bench.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+// the real one is in src/main.cpp, which isn't linked into the benchmarks
+void terminate(int arg) {
+    exit(1);
+}
+
+struct Bench {
+    const char* name;
+    void (*run)();
+};
+
+static const Bench benches[] = {
+    {"eventloop", benchEventLoop},
+    {"chunkmap", benchChunkMap},
+    {"timers", benchTimers},
+    {"mobs", benchMobs},
+    {"statements", benchStatements},
+    {"players", benchPlayers},
+    {"pools", benchPools},
+};
+
+int main(int argc, char** argv) {
+    for (const Bench& bench : benches) {
+        bool wanted = argc < 2;
+        for (int i = 1; i < argc; i++)
+            wanted |= strcmp(argv[i], bench.name) == 0;
+
+        if (!wanted)
+            continue;
+
+        std::cout << "== " << bench.name << std::endl;
+        bench.run();
+    }
+
+    return 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <iostream>
+
+/*
+ * Self-contained checks, run by ctest (or `make check`). Each one returns how many of its cases
+ * failed, after printing what they were.
+ */
+#define CHECK(cond, what) do { \
+        if (!(cond)) { \
+            std::cout << "[FAIL] " << what << std::endl; \
+            failures++; \
+        } \
+    } while (0)
+
+int checkCredentials();
+int checkEncryption();
+int checkChunkMap();
+int checkViewableDelta();
+int checkTimerWheel();
+int checkHandoff();
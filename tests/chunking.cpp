@@ -0,0 +1,139 @@
+#include "checks.hpp"
+#include "Chunking.hpp"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+static std::vector<Chunk*> sorted(NearbyChunks chnks) {
+    std::vector<Chunk*> out(chnks.begin(), chnks.end());
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+// what updatePlayerChunk() and updateNPCChunk() used before the delta was worked out from the move itself
+static std::vector<Chunk*> oldDelta(ChunkPos from, ChunkPos to) {
+    NearbyChunks a = Chunking::getViewableChunks(from), b = Chunking::getViewableChunks(to);
+    std::vector<Chunk*> out;
+    std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
+    return out;
+}
+
+static std::string posString(ChunkPos pos) {
+    return "(" + std::to_string(std::get<0>(pos)) + ", " + std::to_string(std::get<1>(pos)) + ", "
+        + std::to_string(std::get<2>(pos)) + ")";
+}
+
+/*
+ * Runs random insert/erase/find sequences against a ChunkMap and a std::map side by side. Keys are
+ * packed into a small area across a few instances so probe runs collide, wrap around the end of
+ * the table and get torn up by erases, and the map is grown from empty a few times over.
+ */
+int checkChunkMap() {
+    int failures = 0;
+    std::mt19937 rng(6);
+
+    for (int round = 0; round < 4; round++) {
+        ChunkMap map;
+        std::map<ChunkPos, Chunk*> expected;
+        std::vector<Chunk> values(64); // only the addresses matter
+        int side = 8 << round; // 8x8 up to 64x64 per instance
+
+        for (int i = 0; i < 50000; i++) {
+            ChunkPos pos = std::make_tuple((int)(rng() % side) - side / 2, (int)(rng() % side) - side / 2, (uint64_t)(rng() % 3) << 32);
+
+            switch (rng() % 4) {
+            case 0:
+            case 1: {
+                Chunk* value = &values[rng() % values.size()];
+                map.insert(pos, value);
+                expected[pos] = value;
+                break;
+            }
+            case 2:
+                map.erase(pos);
+                expected.erase(pos);
+                break;
+            }
+
+            auto it = expected.find(pos);
+            CHECK(map.find(pos) == (it == expected.end() ? nullptr : it->second), "ChunkMap::find " << posString(pos) << " after step " << i);
+            CHECK(map.size() == expected.size(), "ChunkMap::size after step " << i);
+            if (failures > 0)
+                return failures; // everything after the first mismatch is noise
+        }
+
+        // every key should still be there, and nothing else
+        for (auto& pair : expected)
+            CHECK(map.find(pair.first) == pair.second, "ChunkMap::find " << posString(pair.first) << " at the end");
+
+        size_t visited = 0;
+        map.forEach([&](ChunkPos pos, Chunk* chunk) {
+            visited++;
+            auto it = expected.find(pos);
+            CHECK(it != expected.end() && it->second == chunk, "ChunkMap::forEach gave " << posString(pos));
+        });
+        CHECK(visited == expected.size(), "ChunkMap::forEach visited " << visited << " of " << expected.size());
+    }
+
+    return failures;
+}
+
+/*
+ * Fills a patch of two instances with chunks at random, so every window has some holes in it,
+ * then compares getViewableDelta() against the set difference of the two windows for steps in
+ * every direction, longer jumps and instance changes.
+ */
+int checkViewableDelta() {
+    int failures = 0;
+    std::mt19937 rng(7);
+    std::vector<Chunk*> made;
+
+    for (uint64_t inst : {(uint64_t)0, (uint64_t)5}) {
+        for (int x = -12; x <= 12; x++) {
+            for (int y = -12; y <= 12; y++) {
+                if (rng() % 3 == 0)
+                    continue;
+
+                Chunk* chunk = new Chunk();
+                chunk->pos = std::make_tuple(x, y, inst);
+                Chunking::chunks.insert(chunk->pos, chunk);
+                made.push_back(chunk);
+            }
+        }
+    }
+
+    for (int i = 0; i < 20000; i++) {
+        int x = (int)(rng() % 21) - 10, y = (int)(rng() % 21) - 10;
+        uint64_t inst = rng() % 2 == 0 ? 0 : 5;
+        ChunkPos from = std::make_tuple(x, y, inst);
+
+        ChunkPos to;
+        switch (rng() % 4) {
+        case 0: // jump anywhere, possibly into the other instance
+            to = std::make_tuple((int)(rng() % 21) - 10, (int)(rng() % 21) - 10, rng() % 2 == 0 ? 0 : 5);
+            break;
+        case 1: // same spot, other instance
+            to = std::make_tuple(x, y, inst == 0 ? 5 : 0);
+            break;
+        default: // a short step, including staying put
+            to = std::make_tuple(x + (int)(rng() % 5) - 2, y + (int)(rng() % 5) - 2, inst);
+            break;
+        }
+
+        NearbyChunks toExit, toEnter;
+        Chunking::getViewableDelta(from, to, toExit, toEnter);
+
+        CHECK(sorted(toExit) == oldDelta(from, to) && sorted(toEnter) == oldDelta(to, from),
+            "getViewableDelta " << posString(from) << " -> " << posString(to));
+    }
+
+    for (Chunk* chunk : made) {
+        Chunking::chunks.erase(chunk->pos);
+        delete chunk;
+    }
+
+    return failures;
+}
@@ -0,0 +1,172 @@
+#include "bench.hpp"
+#include "Chunking.hpp"
+
+#include <iomanip>
+#include <random>
+
+/*
+ * What a chunk change cost before the flat hash grid: chunks in a std::map keyed on the position
+ * tuple, members in std::sets, and both 3x3 windows and their differences built as fresh std::sets.
+ */
+namespace Old {
+    struct Chunk {
+        std::set<int32_t> NPCs;
+    };
+
+    static std::map<ChunkPos, Chunk*> chunks;
+
+    static std::set<Chunk*> getViewableChunks(ChunkPos pos) {
+        std::set<Chunk*> chnks;
+
+        int x, y;
+        uint64_t inst;
+        std::tie(x, y, inst) = pos;
+
+        for (int i = -1; i < 2; i++) {
+            for (int z = -1; z < 2; z++) {
+                auto it = chunks.find(std::make_tuple(x+i, y+z, inst));
+                if (it != chunks.end())
+                    chnks.insert(it->second);
+            }
+        }
+
+        return chnks;
+    }
+
+    static void track(ChunkPos pos, int32_t id) {
+        Chunk*& chunk = chunks[pos];
+        if (chunk == nullptr)
+            chunk = new Chunk();
+        chunk->NPCs.insert(id);
+    }
+
+    static void untrack(ChunkPos pos, int32_t id) {
+        auto it = chunks.find(pos);
+        it->second->NPCs.erase(id);
+        if (it->second->NPCs.empty()) {
+            delete it->second;
+            chunks.erase(it);
+        }
+    }
+
+    static size_t move(int32_t id, ChunkPos from, ChunkPos to) {
+        untrack(from, id);
+        track(to, id);
+
+        std::set<Chunk*> oldViewables = getViewableChunks(from);
+        std::set<Chunk*> newViewables = getViewableChunks(to);
+        std::set<Chunk*> toExit, toEnter;
+
+        std::set_difference(oldViewables.begin(), oldViewables.end(), newViewables.begin(), newViewables.end(),
+            std::inserter(toExit, toExit.end()));
+        std::set_difference(newViewables.begin(), newViewables.end(), oldViewables.begin(), oldViewables.end(),
+            std::inserter(toEnter, toEnter.end()));
+
+        return toExit.size() + toEnter.size();
+    }
+
+    static void clear() {
+        for (auto& pair : chunks)
+            delete pair.second;
+        chunks.clear();
+    }
+}
+
+/*
+ * The same thing on Chunking::chunks, with members kept the way trackNPC()/untrackNPC() keep them.
+ * The real ones also go through NPCManager and the instance lists, which are the same either way.
+ */
+namespace New {
+    static void track(ChunkPos pos, int32_t id) {
+        Chunk* chunk = Chunking::chunks.find(pos);
+        if (chunk == nullptr) {
+            chunk = new Chunk();
+            chunk->pos = pos;
+            Chunking::chunks.insert(pos, chunk);
+        }
+        chunk->NPCs.push_back(id);
+    }
+
+    static void untrack(ChunkPos pos, int32_t id) {
+        Chunk* chunk = Chunking::chunks.find(pos);
+        auto it = std::find(chunk->NPCs.begin(), chunk->NPCs.end(), id);
+        *it = chunk->NPCs.back();
+        chunk->NPCs.pop_back();
+        if (chunk->NPCs.empty()) {
+            Chunking::chunks.erase(pos);
+            delete chunk;
+        }
+    }
+
+    static size_t move(int32_t id, ChunkPos from, ChunkPos to) {
+        untrack(from, id);
+        track(to, id);
+
+        NearbyChunks toExit, toEnter;
+        Chunking::getViewableDelta(from, to, toExit, toEnter);
+
+        return toExit.count + toEnter.count;
+    }
+
+    static void clear() {
+        std::vector<Chunk*> all;
+        Chunking::chunks.forEach([&](ChunkPos pos, Chunk* chunk) {
+            all.push_back(chunk);
+        });
+        for (Chunk* chunk : all) {
+            Chunking::chunks.erase(chunk->pos);
+            delete chunk;
+        }
+    }
+}
+
+/*
+ * Scatters entities over a 128x128 chunk patch in each of two instances, then moves random ones
+ * into a neighbouring chunk, which is the work updateNPCChunk() and updatePlayerChunk() do on
+ * every chunk border crossing.
+ */
+template<typename Track, typename Move, typename Clear>
+static double chunkChangeCost(int entities, Track track, Move move, Clear clear) {
+    const int side = 128;
+    std::mt19937 rng(3);
+
+    std::vector<ChunkPos> positions;
+    for (int i = 0; i < entities; i++) {
+        positions.push_back(std::make_tuple((int)(rng() % side), (int)(rng() % side), (uint64_t)(i % 2)));
+        track(positions[i], i);
+    }
+
+    double ns = nsPerRun(500000, [&](long) {
+        int id = rng() % entities;
+        ChunkPos from = positions[id];
+
+        int dx = 0, dy = 0;
+        while (dx == 0 && dy == 0) {
+            dx = (int)(rng() % 3) - 1;
+            dy = (int)(rng() % 3) - 1;
+        }
+
+        int x = std::min(std::max(std::get<0>(from) + dx, 0), side - 1);
+        int y = std::min(std::max(std::get<1>(from) + dy, 0), side - 1);
+        ChunkPos to = std::make_tuple(x, y, std::get<2>(from));
+        if (to == from)
+            return;
+
+        keep(move(id, from, to));
+        positions[id] = to;
+    });
+
+    clear();
+    return ns;
+}
+
+void benchChunkMap() {
+    std::cout << "   entities  std::map  ChunkMap   (ns per chunk change)" << std::endl;
+    for (int entities : {1000, 5000, 20000}) {
+        double oldCost = chunkChangeCost(entities, Old::track, Old::move, Old::clear);
+        double newCost = chunkChangeCost(entities, New::track, New::move, New::clear);
+
+        std::cout << std::setw(11) << entities << std::fixed << std::setprecision(1)
+            << std::setw(10) << oldCost << std::setw(10) << newCost << std::endl;
+    }
+}
@@ -0,0 +1,87 @@
+#include "checks.hpp"
+#include "servers/Credentials.hpp"
+
+#include <random>
+#include <regex>
+#include <string>
+
+// what CNLoginServer used before the checks were written out by hand
+static const std::regex loginRegex("[a-zA-Z0-9_-]{4,32}");
+static const std::regex passwordRegex("[a-zA-Z0-9!@#$%^&*()_+]{8,32}");
+static const std::regex nameRegex(R"(((?! )(?!\.)[a-zA-Z0-9]*\.{0,1}(?!\.+ +)[a-zA-Z0-9]* {0,1}(?! +))*$)");
+
+static bool oldLoginDataGood(const std::string& login, const std::string& password) {
+    return std::regex_match(login, loginRegex) && std::regex_match(password, passwordRegex);
+}
+
+static bool oldNameGood(const std::string& name) {
+    return std::regex_match(name, nameRegex);
+}
+
+static int compareLogin(const std::string& login, const std::string& password) {
+    int failures = 0;
+    CHECK(Credentials::isLoginDataGood(login, password) == oldLoginDataGood(login, password),
+        "isLoginDataGood(\"" << login << "\", \"" << password << "\")");
+    return failures;
+}
+
+static int compareName(const std::string& name) {
+    int failures = 0;
+    CHECK(Credentials::isCharacterNameGood(name, "Smith") == oldNameGood(name),
+        "isCharacterNameGood(\"" << name << "\")");
+    return failures;
+}
+
+int checkCredentials() {
+    int failures = 0;
+
+    // every byte at the start, middle and end of logins and passwords around the length limits
+    for (int len : {3, 4, 8, 31, 32, 33}) {
+        for (int c = 1; c < 256; c++) {
+            for (int pos : {0, len / 2, len - 1}) {
+                std::string s(len, 'a');
+                s[pos] = (char)c;
+                failures += compareLogin(s, "password");
+                failures += compareLogin("login", s);
+            }
+        }
+    }
+
+    // random mixes of accepted and rejected characters
+    const std::string pool = "aZ09_-!@#$%^&*()+ .~\"\\";
+    std::mt19937 rng(1);
+    for (int i = 0; i < 20000; i++) {
+        std::string login(rng() % 36, 0), password(rng() % 36, 0);
+        for (char& c : login)
+            c = pool[rng() % pool.size()];
+        for (char& c : password)
+            c = pool[rng() % pool.size()];
+        failures += compareLogin(login, password);
+    }
+
+    // every name up to 5 characters made of a letter, a digit, a dot, a space and a rejected character
+    const char alphabet[] = {'a', '0', '.', ' ', '-'};
+    std::string name;
+    for (size_t len = 0; len <= 5; len++) {
+        size_t total = 1;
+        for (size_t i = 0; i < len; i++)
+            total *= sizeof(alphabet);
+
+        for (size_t n = 0; n < total; n++) {
+            name.clear();
+            for (size_t i = 0, rest = n; i < len; i++, rest /= sizeof(alphabet))
+                name += alphabet[rest % sizeof(alphabet)];
+            failures += compareName(name);
+        }
+    }
+
+    // and every byte on its own and between letters
+    for (int c = 1; c < 256; c++) {
+        std::string s(1, (char)c);
+        failures += compareName(s);
+        failures += compareName("a" + s);
+        failures += compareName("a" + s + "a");
+    }
+
+    return failures;
+}
@@ -0,0 +1,80 @@
+#include "checks.hpp"
+
+// the xor kernels are static, so pull in the whole file rather than linking it
+#include "core/CNEncryption.cpp"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+typedef int (*XorHandler)(uint8_t* buffer, uint8_t* key, int size);
+
+// runs kernel over every size up to a few vectors' worth (plus some packet-sized ones) at every
+// misalignment, and compares the result and the bytes around it with the one-byte-at-a-time version
+static int compareKernel(const char* name, XorHandler kernel) {
+    int failures = 0;
+    std::mt19937 rng(4);
+
+    std::vector<int> sizes;
+    for (int size = 0; size <= 200; size++)
+        sizes.push_back(size);
+    for (int size : {1000, (int)CN_PACKET_BUFFER_SIZE - 1, (int)CN_PACKET_BUFFER_SIZE})
+        sizes.push_back(size);
+
+    std::vector<uint8_t> input(CN_PACKET_BUFFER_SIZE + 64), expected(input.size()), actual(input.size());
+    uint8_t key[CNSocketEncryption::keyLength];
+
+    for (int size : sizes) {
+        for (uint8_t& b : input)
+            b = rng();
+        for (uint8_t& b : key)
+            b = rng();
+
+        for (int offset = 0; offset < 32; offset++) {
+            expected = input;
+            actual = input;
+            xorDataBytes(expected.data() + offset, key, size);
+            int ret = kernel(actual.data() + offset, key, size);
+
+            CHECK(ret == size && expected == actual,
+                name << " differs from the scalar version at size " << size << ", offset " << offset);
+        }
+    }
+
+    return failures;
+}
+
+int checkEncryption() {
+    int failures = 0;
+
+    failures += compareKernel("xorDataWords", xorDataWords);
+#ifdef OF_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+        failures += compareKernel("xorDataSSE2", xorDataSSE2);
+    else
+        std::cout << "[WARN] CPU lacks SSE2, not checking xorDataSSE2" << std::endl;
+
+    if (__builtin_cpu_supports("avx2"))
+        failures += compareKernel("xorDataAVX2", xorDataAVX2);
+    else
+        std::cout << "[WARN] CPU lacks AVX2, not checking xorDataAVX2" << std::endl;
+#endif
+    failures += compareKernel("xorData", CNSocketEncryption::xorData);
+
+    // decrypting undoes encrypting
+    std::mt19937 rng(5);
+    uint64_t key = CNSocketEncryption::createNewKey(123456789, 3, 4);
+    for (int size = 0; size <= 300; size++) {
+        std::vector<uint8_t> plain(size), buf;
+        for (uint8_t& b : plain)
+            b = rng();
+
+        buf = plain;
+        CNSocketEncryption::encryptData(buf.data(), (uint8_t*)&key, size);
+        CNSocketEncryption::decryptData(buf.data(), (uint8_t*)&key, size);
+        CHECK(buf == plain, "decryptData doesn't undo encryptData at size " << size);
+    }
+
+    return failures;
+}
@@ -0,0 +1,84 @@
+#include "bench.hpp"
+#include "core/EventLoop.hpp"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include <iomanip>
+#include <random>
+#include <vector>
+
+#ifndef _WIN32
+/*
+ * How long it takes the loop to report one ready socket out of however many are registered, which
+ * is what every wakeup of CNServer::start() costs before it gets to do any actual work.
+ */
+static double wakeupCost(EventLoop* loop, int connections) {
+    std::vector<int> ours, theirs;
+    for (int i = 0; i < connections; i++) {
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) < 0) {
+            for (int fd : ours)
+                close(fd);
+            for (int fd : theirs)
+                close(fd);
+            return -1;
+        }
+
+        ours.push_back(pair[0]);
+        theirs.push_back(pair[1]);
+        loop->add(pair[0]);
+    }
+
+    std::mt19937 rng(1);
+    std::vector<SocketEvent> events;
+    char byte = 0;
+
+    double ns = nsPerRun(20000, [&](long) {
+        int i = rng() % connections;
+        if (write(theirs[i], &byte, 1) != 1 || loop->wait(events, -1) != 1 || read(ours[i], &byte, 1) != 1)
+            std::cout << "[WARN] wakeup went wrong" << std::endl;
+    });
+
+    for (int i = 0; i < connections; i++) {
+        loop->remove(ours[i]);
+        close(ours[i]);
+        close(theirs[i]);
+    }
+
+    return ns;
+}
+#endif
+
+void benchEventLoop() {
+#ifdef _WIN32
+    std::cout << "needs socketpair(), skipping" << std::endl;
+#else
+    // two descriptors per connection
+    struct rlimit limit;
+    getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+
+    std::cout << "connections      poll     epoll   (us per wakeup)" << std::endl;
+    for (int connections : {10, 100, 1000, 5000}) {
+        PollEventLoop poll;
+        double pollCost = wakeupCost(&poll, connections);
+        double epollCost = -1;
+#ifdef __linux__
+        EpollEventLoop epoll;
+        epollCost = wakeupCost(&epoll, connections);
+#endif
+
+        if (pollCost < 0) {
+            std::cout << connections << ": not enough file descriptors" << std::endl;
+            break;
+        }
+
+        std::cout << std::setw(11) << connections << std::fixed << std::setprecision(2)
+            << std::setw(10) << pollCost / 1000 << std::setw(10) << epollCost / 1000 << std::endl;
+    }
+#endif
+}
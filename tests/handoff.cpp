@@ -0,0 +1,172 @@
+#include "checks.hpp"
+#include "servers/CNLoginServer.hpp"
+#include "servers/CNShardServer.hpp"
+#include "servers/Handoff.hpp"
+#include "core/CNShared.hpp"
+#include "settings.hpp"
+
+#ifndef _WIN32
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/*
+ * Runs a login server here and a shard in a forked child, joined by the handoff socket, the way
+ * "fusion login" and "fusion shard" are. The login server hands over two characters, then checks
+ * that both accounts get let go before it would let them log in again:
+ *  - account 7's character is let go by the shard on its own, as removePlayer() does
+ *  - account 8's character never shows up in game, so the login server has to ask for it
+ *
+ * The shard checks that the characters arrived intact, and once its SAVED for account 7 has gone
+ * out, reports back through a pipe. Only then does the login server kick account 8, so by the time
+ * that answer arrives, account 7 has to be free already, without a kick of its own.
+ */
+static const uint16_t LOGINPORT = 23410, SHARDPORT = 23411;
+static const int64_t SERIALKEYS[] = {1000, 1001};
+static const int32_t ACCOUNTS[] = {7, 8};
+
+static Player testPlayer(int i) {
+    Player plr = {};
+    plr.iID = 100 + i;
+    plr.accountId = ACCOUNTS[i];
+    plr.HP = 1234 + i;
+    plr.money = 5678 + i;
+    return plr;
+}
+
+struct CheckShard : CNShardServer {
+    int report; // write end of the pipe
+    char good = 'y';
+    bool left = false, reported = false;
+
+    CheckShard(uint16_t p, int fd) : CNShardServer(p), report(fd) {}
+
+    void onStep() override {
+        CNShardServer::onStep();
+
+        if (!left && CNSharedData::hasPlayer(SERIALKEYS[0]) && CNSharedData::hasPlayer(SERIALKEYS[1])) {
+            for (int i = 0; i < 2; i++) {
+                Player got = CNSharedData::getPlayer(SERIALKEYS[i]), sent = testPlayer(i);
+                if (got.iID != sent.iID || got.accountId != sent.accountId || got.HP != sent.HP || got.money != sent.money)
+                    good = 'n';
+            }
+
+            Player plr = CNSharedData::getPlayer(SERIALKEYS[0]);
+            Handoff::playerLeft(&plr);
+            left = true;
+        }
+
+        // nothing left to send means the SAVED is on its way
+        if (left && !reported && !Handoff::pending())
+            reported = write(report, &good, 1) == 1;
+    }
+};
+
+struct CheckLogin : CNLoginServer {
+    pid_t shard;
+    int report; // read end of the pipe
+    time_t deadline;
+    int stage = 0;
+    char good = 0;
+    bool released = false, shardDied = false;
+
+    CheckLogin(uint16_t p, pid_t child, int fd) : CNLoginServer(p), shard(child), report(fd), deadline(getTime() + 10000) {}
+
+    void onStep() override {
+        // a shard that's gone lets everything go, which would pass for the real thing
+        int status;
+        if (waitpid(shard, &status, WNOHANG) == shard) {
+            shardDied = true;
+            kill();
+            return;
+        }
+
+        uint16_t port;
+        switch (stage) {
+        case 0: { // sendPlayer() fails until the shard has connected and said which port it's on
+            Player a = testPlayer(0), b = testPlayer(1);
+            if (Handoff::sendPlayer(SERIALKEYS[0], a, &port)) {
+                Handoff::sendPlayer(SERIALKEYS[1], b, &port);
+                stage = 1;
+            }
+            break;
+        }
+        case 1: { // wait for the shard to have let account 7 go
+            struct pollfd pfd = {report, POLLIN, 0};
+            if (poll(&pfd, 1, 0) == 1 && read(report, &good, 1) == 1)
+                stage = 2;
+            break;
+        }
+        case 2:
+            if (!Handoff::holdForSave(ACCOUNTS[1]))
+                stage = 3;
+            break;
+        case 3:
+            released = !Handoff::holdForSave(ACCOUNTS[0]);
+            kill();
+            return;
+        }
+
+        CNLoginServer::onStep();
+        if (getTime() > deadline)
+            kill();
+    }
+};
+
+int checkHandoff() {
+    int failures = 0;
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        return 1;
+    }
+
+    std::string oldMode = settings::SERVERMODE, oldSocket = settings::HANDOFFSOCKET;
+    settings::HANDOFFSOCKET = "/tmp/openfusion-check-" + std::to_string(getpid()) + ".sock";
+    settings::SHARDPORT = SHARDPORT;
+
+    std::cout.flush(); // or the child prints it again
+    pid_t child = fork();
+    if (child == 0) {
+        close(fds[0]);
+        signal(SIGPIPE, SIG_IGN);
+        usleep(100000); // let the login server get its socket up first, like it usually would
+
+        settings::SERVERMODE = "shard";
+        CheckShard shard(SHARDPORT, fds[1]);
+        Handoff::connect(&shard);
+        shard.start();
+        _exit(0);
+    }
+    close(fds[1]);
+
+    settings::SERVERMODE = "login";
+    {
+        CheckLogin login(LOGINPORT, child, fds[0]);
+        Handoff::listen(&login);
+        login.start();
+
+        CHECK(!login.shardDied, "handoff: shard process exited early");
+        CHECK(login.stage > 0, "handoff: shard never connected");
+        CHECK(login.stage > 1, "handoff: shard never let account " << ACCOUNTS[0] << " go");
+        CHECK(login.stage < 2 || login.good == 'y', "handoff: players didn't arrive on the shard intact");
+        CHECK(login.stage > 2, "handoff: account " << ACCOUNTS[1] << " wasn't let go after a kick");
+        CHECK(login.stage < 3 || login.released, "handoff: account " << ACCOUNTS[0] << " was still held after the shard let it go");
+    }
+
+    ::kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+    close(fds[0]);
+    unlink(settings::HANDOFFSOCKET.c_str());
+
+    settings::SERVERMODE = oldMode;
+    settings::HANDOFFSOCKET = oldSocket;
+    return failures;
+}
+#else
+int checkHandoff() {
+    return 0; // no Unix domain sockets; the login server and shards always share a process here
+}
+#endif
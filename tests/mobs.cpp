@@ -0,0 +1,62 @@
+#include "bench.hpp"
+
+// the tick is static, so pull in the whole file rather than linking it
+#include "MobAI.cpp"
+
+#include <iomanip>
+
+// how step() picked its mobs before the active list: every one of them, every tick
+static void scanStep(time_t currTime) {
+    intents.clear();
+    for (auto& pair : Mobs)
+        intents.push_back({pair.second, false, nullptr});
+
+    thinkAll(currTime);
+
+    // the awake ones are all INACTIVE below, which step() doesn't do anything with either
+    int awake = 0;
+    for (MobIntent& intent : intents) {
+        if (!isAsleep(intent.mob))
+            awake++;
+    }
+    keep(awake);
+}
+
+/*
+ * A map's worth of mobs with only a few of them in sight of a player, which is what most of the
+ * world looks like most of the time. The ones in sight are INACTIVE, so neither side does any
+ * actual AI work for them; what's left is the cost of working out who to step.
+ */
+static void compare(int mobs, int visible) {
+    static MobTemplate data = {};
+    simulateMobs = true;
+
+    for (int i = 0; i < mobs; i++) {
+        Mob* mob = new Mob(i * 100, 0, 0, 0, 0, 0, &data, i + 1);
+        Mobs[i + 1] = mob;
+
+        if (i % (mobs / visible) == 0) {
+            mob->state = MobState::INACTIVE;
+            mob->playersInView = 1;
+            MobAI::updateActive(mob);
+        }
+    }
+
+    double scan = nsPerRun(2000, [](long i) { scanStep(i * 200); });
+    double active = nsPerRun(2000, [](long i) { step(nullptr, i * 200); });
+
+    for (auto& pair : Mobs) {
+        MobAI::deactivate(pair.second);
+        delete pair.second;
+    }
+    Mobs.clear();
+
+    std::cout << std::setw(9) << mobs << std::setw(9) << visible << std::fixed << std::setprecision(2)
+        << std::setw(10) << scan / 1000 << std::setw(10) << active / 1000 << std::endl;
+}
+
+void benchMobs() {
+    std::cout << "     mobs  in view full scan    active   (us per tick)" << std::endl;
+    for (int mobs : {1000, 10000, 50000})
+        compare(mobs, 100);
+}
@@ -0,0 +1,100 @@
+#include "bench.hpp"
+
+// the indexes are static, so pull in the whole file rather than linking it
+#include "PlayerManager.cpp"
+
+#include <iomanip>
+#include <random>
+
+// how the lookups went before the indexes: through every online player, converting names as they go
+namespace Scan {
+    static Player* getPlayerFromID(int32_t iID) {
+        for (auto& pair : players)
+            if (pair.second->iID == iID)
+                return pair.second;
+
+        return nullptr;
+    }
+
+    static CNSocket* getSockFromName(std::string firstname, std::string lastname) {
+        for (auto& pair : players)
+            if (AUTOU16TOU8(pair.second->PCStyle.szFirstName) == firstname
+            && AUTOU16TOU8(pair.second->PCStyle.szLastName) == lastname)
+                return pair.first;
+
+        return nullptr;
+    }
+
+    static bool isAccountInUse(int accountId) {
+        for (auto& pair : players)
+            if (pair.second->accountId == accountId)
+                return true;
+
+        return false;
+    }
+}
+
+static void row(int online, const char* lookup, double scan, double index) {
+    std::cout << std::setw(9) << online << std::setw(17) << lookup << std::fixed << std::setprecision(1)
+        << std::setw(11) << scan << std::setw(10) << index << std::endl;
+}
+
+/*
+ * Looks up random online players by ID, name and account, the way group ticks, buddy and email
+ * handlers and GM commands do. The players are only ever looked at, never connected, so their
+ * sockets are just distinct addresses.
+ */
+static void compare(int online) {
+    std::vector<char> sockets(online);
+    std::vector<Player*> added;
+
+    for (int i = 0; i < online; i++) {
+        Player* plr = new Player();
+        plr->iID = 1000 + i;
+        plr->accountId = 500 + i;
+        U8toU16("First" + std::to_string(i), plr->PCStyle.szFirstName, ARRLEN(plr->PCStyle.szFirstName));
+        U8toU16("Last" + std::to_string(i), plr->PCStyle.szLastName, ARRLEN(plr->PCStyle.szLastName));
+
+        CNSocket* sock = (CNSocket*)&sockets[i];
+        players[sock] = plr;
+        indexPlayer(sock, plr);
+        added.push_back(plr);
+    }
+
+    std::mt19937 rng(22);
+    std::vector<int> targets;
+    for (int i = 0; i < 1000; i++)
+        targets.push_back(rng() % online);
+
+    const long runs = online >= 1000 ? 20000 : 200000;
+    row(online, "getPlayerFromID",
+        nsPerRun(runs, [&](long i) { keep(Scan::getPlayerFromID(1000 + targets[i % 1000])); }),
+        nsPerRun(runs, [&](long i) { keep(PlayerManager::getPlayerFromID(1000 + targets[i % 1000])); }));
+
+    // the strings are made up front, so only the lookup itself is timed
+    std::vector<std::string> firsts, lasts;
+    for (int target : targets) {
+        firsts.push_back("First" + std::to_string(target));
+        lasts.push_back("Last" + std::to_string(target));
+    }
+    row(online, "getSockFromName",
+        nsPerRun(runs / 10, [&](long i) { keep(Scan::getSockFromName(firsts[i % 1000], lasts[i % 1000])); }),
+        nsPerRun(runs, [&](long i) { keep(PlayerManager::getSockFromName(firsts[i % 1000], lasts[i % 1000])); }));
+
+    row(online, "isAccountInUse",
+        nsPerRun(runs, [&](long i) { keep(Scan::isAccountInUse(500 + targets[i % 1000])); }),
+        nsPerRun(runs, [&](long i) { keep(PlayerManager::isAccountInUse(500 + targets[i % 1000])); }));
+
+    for (int i = 0; i < online; i++) {
+        CNSocket* sock = (CNSocket*)&sockets[i];
+        unindexPlayer(sock, added[i]);
+        players.erase(sock);
+        delete added[i];
+    }
+}
+
+void benchPlayers() {
+    std::cout << "  players           lookup       scan     index   (ns per call)" << std::endl;
+    for (int online : {10, 100, 1000, 5000})
+        compare(online);
+}
@@ -0,0 +1,61 @@
+#include "bench.hpp"
+#include "Chunking.hpp"
+#include "MobAI.hpp"
+#include "Player.hpp"
+
+#include <iomanip>
+#include <random>
+
+/*
+ * Entities coming and going while others stay put: live objects are allocated up front, then one at
+ * a time a random one is freed and replaced, the way mobs in lairs and chunks at borders churn. Each
+ * new object gets written to, so what's measured includes getting its memory into cache. The plain
+ * side is what `new` did before the pools; the pooled side goes through the class's own operator
+ * new/delete, and so through the same pool (and lock) the server uses.
+ */
+template<typename T>
+static void compare(const char* name, int live) {
+    const long runs = 1000000;
+    const size_t size = sizeof(T);
+    std::mt19937 rng(23);
+
+    std::vector<int> victims(1 << 16);
+    for (int& victim : victims)
+        victim = rng() % live;
+
+    std::vector<void*> objects(live);
+
+    for (void*& p : objects)
+        p = ::operator new(size);
+    double plain = nsPerRun(runs, [&](long i) {
+        void*& p = objects[victims[i & 0xffff]];
+        ::operator delete(p);
+        p = ::operator new(size);
+        *(long*)p = i;
+    });
+    for (void* p : objects)
+        ::operator delete(p);
+
+    for (void*& p : objects)
+        p = T::operator new(size);
+    double pooled = nsPerRun(runs, [&](long i) {
+        void*& p = objects[victims[i & 0xffff]];
+        T::operator delete(p, size);
+        p = T::operator new(size);
+        *(long*)p = i;
+    });
+    for (void* p : objects)
+        T::operator delete(p, size);
+
+    std::cout << std::setw(8) << name << std::setw(6) << size << std::setw(8) << live << std::fixed << std::setprecision(1)
+        << std::setw(12) << plain << std::setw(10) << pooled << std::endl;
+}
+
+void benchPools() {
+    std::cout << "  object  size    live  new/delete    pooled   (ns per replacement)" << std::endl;
+    for (int live : {1000, 10000, 100000}) {
+        compare<Chunk>("Chunk", live);
+        compare<Mob>("Mob", live);
+        compare<Player>("Player", live);
+    }
+}
@@ -0,0 +1,89 @@
+#include "bench.hpp"
+#include "db/internal.hpp"
+#include "settings.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+
+// the same SQL as Database::findAccount() and Database::getCharInfo(), the two lookups behind every login
+static const char* FINDACCOUNT = R"(
+        SELECT AccountID, Password, Selected, BannedUntil, BanReason
+        FROM Accounts
+        WHERE Login = ?
+        LIMIT 1;
+        )";
+static const char* GETCHARINFO = R"(
+        SELECT
+            p.PlayerID, p.Slot, p.FirstName, p.LastName, p.Level, p.AppearanceFlag, p.TutorialFlag, p.PayZoneFlag,
+            p.XCoordinate, p.YCoordinate, p.ZCoordinate, p.NameCheck,
+            a.Body, a.EyeColor, a.FaceStyle, a.Gender, a.HairColor, a.HairStyle, a.Height, a.SkinColor
+        FROM Players as p
+        INNER JOIN Appearances as a ON p.PlayerID = a.PlayerID
+        WHERE p.AccountID = ?;
+        )";
+
+/*
+ * One lookup that finds its row, run both ways: prepared and finalized around every call like the
+ * db layer used to, and through getStatement()/releaseStatement().
+ */
+template<typename Bind>
+static void compare(const char* name, const char* sql, sqlite3* conn, Bind bind) {
+    const long runs = 20000;
+    long misses = 0;
+
+    double fresh = nsPerRun(runs, [&](long) {
+        sqlite3_stmt* stmt;
+        sqlite3_prepare_v2(conn, sql, -1, &stmt, NULL);
+        bind(stmt);
+        misses += sqlite3_step(stmt) != SQLITE_ROW;
+        sqlite3_finalize(stmt);
+    });
+
+    double cached = nsPerRun(runs, [&](long) {
+        sqlite3_stmt* stmt = getStatement(sql, conn);
+        bind(stmt);
+        misses += sqlite3_step(stmt) != SQLITE_ROW;
+        releaseStatement(stmt);
+    });
+
+    if (misses > 0)
+        std::cout << "[WARN] " << name << " came up empty " << misses << " times" << std::endl;
+
+    std::cout << std::setw(12) << name << std::fixed << std::setprecision(2)
+        << std::setw(10) << fresh / 1000 << std::setw(10) << cached / 1000 << std::endl;
+}
+
+void benchStatements() {
+    // Database::open() reads the schema from here, same as the server
+    if (!std::ifstream("sql/tables.sql").is_open()) {
+        std::cout << "needs sql/tables.sql; run from the top of the repository, skipping" << std::endl;
+        return;
+    }
+
+    settings::DBPATH = (std::filesystem::temp_directory_path() / "openfusion-bench.db").string();
+    for (const char* suffix : {"", "-wal", "-shm"})
+        std::remove((settings::DBPATH + suffix).c_str()); // left behind by a run that didn't finish
+    Database::open();
+
+    int accountId = Database::addAccount("benchaccount", "not a real hash");
+
+    INITSTRUCT(sP_CL2LS_REQ_SAVE_CHAR_NAME, save);
+    save.iSlotNum = 1;
+    U8toU16("Bench", save.szFirstName, sizeof(save.szFirstName));
+    U8toU16("Mark", save.szLastName, sizeof(save.szLastName));
+    Database::createCharacter(&save, accountId);
+
+    std::cout << "       query   prepare    cached   (us per call)" << std::endl;
+    compare("findAccount", FINDACCOUNT, readDb, [](sqlite3_stmt* stmt) {
+        sqlite3_bind_text(stmt, 1, "benchaccount", -1, NULL);
+    });
+    compare("getCharInfo", GETCHARINFO, readDb, [accountId](sqlite3_stmt* stmt) {
+        sqlite3_bind_int(stmt, 1, accountId);
+    });
+
+    Database::close();
+    for (const char* suffix : {"", "-wal", "-shm"})
+        std::remove((settings::DBPATH + suffix).c_str());
+}
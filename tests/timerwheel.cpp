@@ -0,0 +1,104 @@
+#include "checks.hpp"
+#include "core/TimerWheel.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <vector>
+
+struct Pending {
+    uint64_t id;
+    time_t deadline;
+};
+
+/*
+ * Drives a TimerWheel with random schedules, cancels and clock jumps, and keeps a plain list of
+ * what should be pending next to it. After every step, the timers that fired (and their order),
+ * cancel()'s answers, nextDeadline() and size() all have to match what the list says.
+ *
+ * Deadlines go from overdue up to a few laps of the wheel out, the clock sometimes skips more than
+ * a lap at once, and some callbacks schedule a follow-up from inside advance().
+ */
+int checkTimerWheel() {
+    int failures = 0;
+    std::mt19937 rng(13);
+
+    TimerWheel wheel;
+    std::vector<Pending> pending; // kept sorted by deadline, then id, which is the order they should fire in
+    std::vector<uint64_t> ids; // what each callback's id turned out to be, since it can't know that itself
+    std::vector<uint64_t> fired, gone;
+    time_t now = 1000000;
+
+    std::function<void(time_t, bool)> add = [&](time_t deadline, bool followUp) {
+        size_t token = ids.size();
+        ids.push_back(0);
+
+        ids[token] = wheel.schedule(deadline, [&, token, followUp](time_t at) {
+            fired.push_back(ids[token]);
+            if (followUp)
+                add(at + 1 + rng() % 300, false); // schedule() has to be safe to call from inside advance()
+        });
+
+        // ties go after, since later ids fire later
+        pending.insert(std::upper_bound(pending.begin(), pending.end(), deadline, [](time_t d, const Pending& p) {
+            return d < p.deadline;
+        }), {ids[token], deadline});
+    };
+
+    wheel.advance(now); // so the wheel's clock starts where ours does instead of at getTime()
+
+    for (int step = 0; step < 100000; step++) {
+        switch (rng() % 10) {
+        case 0: case 1: case 2: case 3: {
+            time_t deadline;
+            switch (rng() % 4) {
+            case 0: deadline = now - rng() % 100; break; // already overdue
+            case 1: deadline = now + rng() % 20000; break; // up to ~4 laps out
+            default: deadline = now + rng() % 500; break;
+            }
+            add(deadline, rng() % 8 == 0);
+            break;
+        }
+        case 4: case 5: {
+            // half the time something that's live, otherwise something that has already fired
+            bool live = !pending.empty() && (gone.empty() || rng() % 2 == 0);
+            if (live) {
+                size_t i = rng() % pending.size();
+                CHECK(wheel.cancel(pending[i].id), "cancel() of live timer " << pending[i].id << " at step " << step);
+                pending.erase(pending.begin() + i);
+            } else if (!gone.empty()) {
+                uint64_t id = gone[rng() % gone.size()];
+                CHECK(!wheel.cancel(id), "cancel() of finished timer " << id << " at step " << step);
+            }
+            break;
+        }
+        default: {
+            now += rng() % 8 == 0 ? rng() % 12000 : rng() % 40;
+
+            // everything due, in firing order; follow-ups land in pending as they're scheduled
+            std::vector<uint64_t> expected;
+            auto due = std::upper_bound(pending.begin(), pending.end(), now, [](time_t n, const Pending& p) {
+                return n < p.deadline;
+            });
+            for (auto it = pending.begin(); it != due; it++)
+                expected.push_back(it->id);
+            pending.erase(pending.begin(), due);
+
+            fired.clear();
+            wheel.advance(now);
+            CHECK(fired == expected, "advance(" << now << ") fired " << fired.size() << " timers, expected " << expected.size() << " at step " << step);
+
+            gone.insert(gone.end(), expected.begin(), expected.end());
+            break;
+        }
+        }
+
+        time_t next = pending.empty() ? -1 : pending.front().deadline;
+        CHECK(wheel.nextDeadline() == next, "nextDeadline() was " << wheel.nextDeadline() << ", expected " << next << " at step " << step);
+        CHECK(wheel.size() == pending.size(), "size() was " << wheel.size() << ", expected " << pending.size() << " at step " << step);
+        if (failures > 0)
+            return failures; // everything after the first mismatch is noise
+    }
+
+    return failures;
+}